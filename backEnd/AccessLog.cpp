@@ -0,0 +1,350 @@
+#include "AccessLog.h"
+#include "LogM.h"
+#include "Router.h"
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <unistd.h>
+
+namespace {
+
+thread_local RequestTrace* t_trace = nullptr;
+
+constexpr size_t kWriteChunk = 256 * 1024; // 编码缓冲攒到这么大就写一次
+constexpr size_t kMaxLine = 384;           // 单行 NDJSON 的上限（全部字段取最大值时约 300 字节）
+
+int64_t steadyNs(std::chrono::steady_clock::time_point tp)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+}
+
+char* putField(char* p, const char* name, size_t nameLen, uint64_t v)
+{
+    std::memcpy(p, name, nameLen);
+    p += nameLen;
+    return std::to_chars(p, p + 20, v).ptr;
+}
+
+char* putIp(char* p, uint32_t ipNetOrder)
+{
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(&ipNetOrder);
+    for (int i = 0; i < 4; ++i) {
+        if (i) *p++ = '.';
+        p = std::to_chars(p, p + 3, b[i]).ptr;
+    }
+    return p;
+}
+
+#define ACCESS_FIELD(p, lit, v) putField(p, lit, sizeof(lit) - 1, static_cast<uint64_t>(v))
+
+// 编码为 NDJSON。时间戳的秒数部分一秒才变一次，缓存其十进制串，避免每条做 64 位大数转换
+class LineEncoder {
+public:
+    explicit LineEncoder(int64_t wallOffsetNs) : wallOffsetNs_(wallOffsetNs) {}
+
+    // 返回写入的字节数（buf 至少 kMaxLine 字节）
+    size_t encode(const AccessRecord& r, char* buf)
+    {
+        char* p = buf;
+        std::memcpy(p, "{\"ts\":", 6);
+        p = putTimestamp(p + 6, (r.startNs + wallOffsetNs_) / 1000);
+        std::memcpy(p, ",\"ip\":\"", 7);
+        p = putIp(p + 7, r.clientIp);
+        std::memcpy(p, "\",\"method\":\"", 12);
+        p += 12;
+        const char* method = methodToString(static_cast<HttpMethod>(r.method));
+        size_t methodLen = std::strlen(method);
+        std::memcpy(p, method, methodLen);
+        p += methodLen;
+        std::memcpy(p, "\",\"route\":", 10);
+        p += 10;
+        p = std::to_chars(p, p + 11, r.routeId).ptr;
+        p = ACCESS_FIELD(p, ",\"status\":", r.status);
+        p = ACCESS_FIELD(p, ",\"bytesIn\":", r.bytesIn);
+        p = ACCESS_FIELD(p, ",\"bytesOut\":", r.bytesOut);
+        p = ACCESS_FIELD(p, ",\"parseUs\":", r.parseUs);
+        p = ACCESS_FIELD(p, ",\"handlerUs\":", r.handlerUs);
+        p = ACCESS_FIELD(p, ",\"dbUs\":", r.dbUs);
+        p = ACCESS_FIELD(p, ",\"bcryptUs\":", r.bcryptUs);
+        p = ACCESS_FIELD(p, ",\"totalUs\":", r.totalUs);
+        p = ACCESS_FIELD(p, ",\"connRequest\":", r.connRequest);
+        *p++ = '}';
+        *p++ = '\n';
+        return static_cast<size_t>(p - buf);
+    }
+
+private:
+    // Unix 微秒：缓存的秒数串 + 补零的 6 位微秒
+    char* putTimestamp(char* p, int64_t us)
+    {
+        int64_t sec = us / 1000000;
+        uint32_t frac = static_cast<uint32_t>(us - sec * 1000000);
+        if (sec != cachedSec_) {
+            cachedSec_ = sec;
+            secLen_ = static_cast<size_t>(std::to_chars(secDigits_, secDigits_ + sizeof(secDigits_), sec).ptr - secDigits_);
+        }
+        std::memcpy(p, secDigits_, secLen_);
+        p += secLen_;
+        for (int i = 5; i >= 0; --i) {
+            p[i] = static_cast<char>('0' + frac % 10);
+            frac /= 10;
+        }
+        return p + 6;
+    }
+
+    int64_t wallOffsetNs_;
+    int64_t cachedSec_ = -1;
+    char secDigits_[20];
+    size_t secLen_ = 0;
+};
+
+#undef ACCESS_FIELD
+
+} // namespace
+
+// -------------------- RequestTrace --------------------
+
+RequestTrace* RequestTrace::current()
+{
+    return t_trace;
+}
+
+RequestTrace::Scope::Scope(RequestTrace* trace)
+    : prev_(t_trace)
+{
+    t_trace = trace;
+}
+
+RequestTrace::Scope::~Scope()
+{
+    t_trace = prev_;
+}
+
+PhaseTimer::~PhaseTimer()
+{
+    if (!trace_) return;
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_).count();
+    auto& slot = phase_ == TracePhase::Db ? trace_->dbUs : trace_->bcryptUs;
+    slot.fetch_add(static_cast<uint32_t>(us), std::memory_order_relaxed);
+}
+
+// -------------------- AccessLog --------------------
+
+// 单生产者/单消费者：生产者为所属线程，消费者为后台线程
+struct AccessLog::Ring {
+    explicit Ring(size_t capacity) : slots(capacity), mask(capacity - 1) {}
+
+    std::vector<AccessRecord> slots;
+    const uint64_t mask;
+    alignas(64) std::atomic<uint64_t> head{0}; // 生产者写
+    alignas(64) std::atomic<uint64_t> tail{0}; // 消费者写
+    std::atomic<bool> retired{false};          // 所属线程已退出，排空后释放
+};
+
+struct AccessLog::RingHandle {
+    Ring* ring = nullptr;
+    ~RingHandle()
+    {
+        if (ring) ring->retired.store(true, std::memory_order_release);
+    }
+};
+
+AccessLog& AccessLog::instance()
+{
+    // 有意不析构：工作线程在 main 返回后仍可能 append；退出时由 atexit 停止后台线程并排空
+    static AccessLog* inst = new AccessLog();
+    return *inst;
+}
+
+AccessLog::AccessLog()
+{
+    std::atexit(&AccessLog::stopAtExit);
+}
+
+AccessLog::~AccessLog()
+{
+    stop();
+}
+
+void AccessLog::stopAtExit()
+{
+    instance().stop();
+}
+
+bool AccessLog::start(const std::string& path, std::chrono::milliseconds flushInterval, size_t ringRecords)
+{
+    if (running_.load()) return true;
+    std::filesystem::path p(path);
+    if (p.has_parent_path()) {
+        std::error_code ec;
+        std::filesystem::create_directories(p.parent_path(), ec);
+    }
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        LOG_ERROR("Open access log %s failed: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+    size_t cap = 64;
+    while (cap < ringRecords) cap <<= 1;
+    ringRecords_ = cap;
+    flushInterval_ = flushInterval;
+    wallOffsetNs_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count() -
+                    steadyNs(std::chrono::steady_clock::now());
+    out_.reset(new char[kWriteChunk + kMaxLine]);
+    running_.store(true);
+    worker_ = std::thread(&AccessLog::run, this);
+    LOG_INFO("Access log enabled: %s", path.c_str());
+    return true;
+}
+
+void AccessLog::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(workerMutex_);
+        if (!running_.exchange(false)) return;
+    }
+    workerCv_.notify_one();
+    if (worker_.joinable()) worker_.join();
+    std::atomic_thread_fence(std::memory_order_seq_cst); // 与 append 中的栅栏配对
+    std::lock_guard<std::mutex> lock(drainMutex_);
+    drain();
+    ::close(fd_);
+    fd_ = -1;
+}
+
+AccessLog::Ring* AccessLog::localRing()
+{
+    static thread_local RingHandle handle;
+    if (handle.ring) return handle.ring;
+
+    auto ring = std::make_unique<Ring>(ringRecords_);
+    handle.ring = ring.get();
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+    rings_.push_back(std::move(ring));
+    return handle.ring;
+}
+
+void AccessLog::append(const AccessRecord& record)
+{
+    if (!enabled()) return;
+    Ring* ring = localRing();
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    uint64_t used = head - ring->tail.load(std::memory_order_acquire);
+    if (used >= ring->slots.size()) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring->slots[head & ring->mask] = record;
+    ring->head.store(head + 1, std::memory_order_release);
+    // 发布后再确认一次：stop() 若已开始，它的最终排空可能没看到这条记录，由本线程补一次
+    // （文件已关闭时计入丢弃），保证每条记录要么写出、要么计数
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!running_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(drainMutex_);
+        drain();
+        return;
+    }
+    // 过半时提前唤醒后台线程，否则等下一个周期
+    if (used + 1 == ring->slots.size() / 2 && !wakePending_.exchange(true, std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(workerMutex_);
+        workerCv_.notify_one();
+    }
+}
+
+AccessLogStats AccessLog::stats() const
+{
+    AccessLogStats s;
+    s.written = written_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void AccessLog::run()
+{
+    std::unique_lock<std::mutex> lock(workerMutex_);
+    while (running_.load(std::memory_order_relaxed)) {
+        workerCv_.wait_for(lock, flushInterval_, [this] {
+            return !running_.load(std::memory_order_relaxed) || wakePending_.load(std::memory_order_relaxed);
+        });
+        wakePending_.store(false, std::memory_order_relaxed);
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> drainLock(drainMutex_);
+            drain();
+        }
+        lock.lock();
+    }
+}
+
+void AccessLog::drain()
+{
+    std::vector<Ring*> rings;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        // 先看 retired 再排空：之后所属线程不会再写入，排空后即可释放
+        for (auto it = rings_.begin(); it != rings_.end();) {
+            Ring* r = it->get();
+            if (r->retired.load(std::memory_order_acquire) &&
+                r->tail.load(std::memory_order_relaxed) == r->head.load(std::memory_order_acquire)) {
+                it = rings_.erase(it);
+                continue;
+            }
+            rings.push_back(r);
+            ++it;
+        }
+    }
+
+    if (fd_ < 0) {
+        // 已停止：不再写文件，剩余记录计入丢弃
+        for (Ring* r : rings) {
+            uint64_t head = r->head.load(std::memory_order_acquire);
+            dropped_.fetch_add(head - r->tail.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            r->tail.store(head, std::memory_order_release);
+        }
+        return;
+    }
+
+    LineEncoder encoder(wallOffsetNs_);
+    char* out = out_.get();
+    size_t len = 0;
+    size_t lines = 0;
+    for (Ring* r : rings) {
+        uint64_t tail = r->tail.load(std::memory_order_relaxed);
+        uint64_t head = r->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            len += encoder.encode(r->slots[tail & r->mask], out + len);
+            ++lines;
+            if (len >= kWriteChunk) {
+                // 先归还已编码的槽位，生产者不必等整批写完
+                r->tail.store(tail + 1, std::memory_order_release);
+                writeOut(out, len, lines);
+                len = 0;
+                lines = 0;
+            }
+        }
+        r->tail.store(tail, std::memory_order_release);
+    }
+    if (len > 0) writeOut(out, len, lines);
+}
+
+void AccessLog::writeOut(const char* data, size_t len, size_t lines)
+{
+    const char* p = data;
+    size_t left = len;
+    while (left > 0) {
+        ssize_t n = ::write(fd_, p, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("Write access log failed: %s", strerror(errno));
+            return;
+        }
+        p += n;
+        left -= static_cast<size_t>(n);
+    }
+    written_.fetch_add(lines, std::memory_order_relaxed);
+}
@@ -0,0 +1,93 @@
+#include "Arena.h"
+#include <cstdlib>
+#include <new>
+
+static thread_local Arena* t_currentArena = nullptr;
+
+// 单块最多保留的大小，防止个别超大请求让连接长期占着内存
+static const size_t kMaxRetainedBytes = 256 * 1024;
+
+Arena::Arena(size_t chunkSize) : chunkSize_(chunkSize)
+{
+}
+
+Arena::~Arena()
+{
+    freeChunks();
+}
+
+Arena* Arena::current()
+{
+    return t_currentArena;
+}
+
+void Arena::addChunk(size_t minBytes)
+{
+    size_t size = chunkSize_;
+    if (size < minBytes + sizeof(Chunk) + alignof(std::max_align_t)) {
+        size = minBytes + sizeof(Chunk) + alignof(std::max_align_t);
+    }
+    Chunk* c = static_cast<Chunk*>(std::malloc(size));
+    if (!c) throw std::bad_alloc();
+    c->next = head_;
+    c->size = size;
+    head_ = c;
+    cur_ = reinterpret_cast<char*>(c) + sizeof(Chunk);
+    end_ = reinterpret_cast<char*>(c) + size;
+    capacity_ += size;
+}
+
+void Arena::freeChunks()
+{
+    while (head_) {
+        Chunk* next = head_->next;
+        std::free(head_);
+        head_ = next;
+    }
+    cur_ = end_ = nullptr;
+    capacity_ = 0;
+}
+
+void* Arena::allocate(size_t bytes, size_t align)
+{
+    uintptr_t p = (reinterpret_cast<uintptr_t>(cur_) + (align - 1)) & ~(uintptr_t)(align - 1);
+    if (!head_ || p + bytes > reinterpret_cast<uintptr_t>(end_)) {
+        addChunk(bytes + align);
+        p = (reinterpret_cast<uintptr_t>(cur_) + (align - 1)) & ~(uintptr_t)(align - 1);
+    }
+    cur_ = reinterpret_cast<char*>(p + bytes);
+    used_ += bytes;
+    return reinterpret_cast<void*>(p);
+}
+
+void Arena::reset()
+{
+    used_ = 0;
+    if (!head_) return;
+    if (head_->next) {
+        // 上一轮跨了多个块：合并为一个块，下一轮一次装下
+        size_t total = capacity_;
+        freeChunks();
+        if (total > kMaxRetainedBytes) total = kMaxRetainedBytes;
+        size_t saved = chunkSize_;
+        chunkSize_ = total;
+        addChunk(0);
+        chunkSize_ = saved < total ? total : saved;
+        return;
+    }
+    if (head_->size > kMaxRetainedBytes) {
+        freeChunks();
+        return;
+    }
+    cur_ = reinterpret_cast<char*>(head_) + sizeof(Chunk);
+}
+
+ArenaScope::ArenaScope(Arena& arena) : prev_(t_currentArena)
+{
+    t_currentArena = &arena;
+}
+
+ArenaScope::~ArenaScope()
+{
+    t_currentArena = prev_;
+}
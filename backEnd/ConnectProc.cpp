@@ -1,170 +1,799 @@
 #include "ConnectProc.h"
 #include <cstring>
-#include <json.hpp>
 #include "logIn.h"
 #include "signUp.h"
 #include "LogM.h"
-#include <sstream> // 新增: 解析请求行需要
-
-using nlohmann::json;
-bool parse_http_request(const std::string& raw, HttpRequest& req)
-{
-    size_t header_end = raw.find("\r\n\r\n");
-    if (header_end == std::string::npos) return false;
-    std::string header_part = raw.substr(0, header_end);
-    std::string body_part   = raw.substr(header_end + 4);
-    size_t line_end = header_part.find("\r\n");
-    if (line_end == std::string::npos) return false;
-    std::string request_line = header_part.substr(0, line_end);
-    {
-        std::istringstream iss(request_line);
-        if (!(iss >> req.method >> req.path >> req.version)) return false;
-    }
-    size_t pos = line_end + 2;
-    while (pos < header_part.size()) {
-        size_t next = header_part.find("\r\n", pos);
-        if (next == std::string::npos) next = header_part.size();
-        std::string line = header_part.substr(pos, next - pos);
-        pos = next + 2;
-        if (line.empty()) continue;
-        size_t colon = line.find(':');
-        if (colon == std::string::npos) continue;
-        std::string key = trim(line.substr(0, colon));
-        std::string value = trim(line.substr(colon + 1));
-        req.headers[key] = value;
-    }
-    // 新增: 解析 token
-    // 优先使用 Authorization: Bearer <token> 形式；否则尝试 Token: <token>
-    auto authIt = req.headers.find("Authorization");
-    if (authIt != req.headers.end()) {
-        std::string authVal = trim(authIt->second);
-        const std::string bearerPrefix = "Bearer ";
-        if (authVal.rfind(bearerPrefix, 0) == 0) {
-            req.token = trim(authVal.substr(bearerPrefix.size()));
-        } else {
-            // 若无 Bearer 前缀，直接全部当作 token
-            req.token = authVal;
-        }
-    } else {
-        auto tokIt = req.headers.find("Token");
-        if (tokIt != req.headers.end()) {
-            req.token = trim(tokIt->second);
-        }
-    }
-    auto it = req.headers.find("Content-Length");
-    if (it != req.headers.end()) {
-        size_t len = static_cast<size_t>(std::stoul(it->second));
-        if (body_part.size() < len) return false;
-        req.body = body_part.substr(0, len);
-    } else {
-        req.body = body_part;
+#include <chrono>
+#include <list>
+#include "ThreadPool.h"
+#include "Arena.h"
+#include "Router.h"
+#include "HashPool.h"
+#include "UserCache.h"
+#include "EmailFilter.h"
+#include "MySQLProc.h"
+#include "AccessLog.h"
+#include "Sha256.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+bool wants_keep_alive(const HttpRequest& req)
+{
+    std::string_view conn = req.headers.get(HeaderId::Connection);
+    if (req.version == "HTTP/1.0") {
+        // HTTP/1.0 默认短连接，需显式 keep-alive
+        return equalsIgnoreCase(conn, "keep-alive");
     }
+    // HTTP/1.1 默认长连接
+    return !equalsIgnoreCase(conn, "close");
+}
+
+// -------------------- 路由 --------------------
+
+// 哈希线程池饱和时快速失败：回复 503 + Retry-After，不再查库、排队
+static bool shedIfHashPoolBusy(const Responder& respond)
+{
+    int retryAfter = 1;
+    if (HashPool::instance().admit(&retryAfter)) return false;
+    char header[32];
+    std::snprintf(header, sizeof(header), "Retry-After: %d\r\n", retryAfter);
+    respond.send(503, R"({"success": false, "message": "服务繁忙，请稍后重试"})", header);
     return true;
 }
 
-// 线程执行函数
-void handle_client(int client_fd)
+static void routeLogin(const HttpRequest& req, const RouteParams&, const Responder& respond)
 {
-    std::string raw;
-    raw.resize(8192);
-    int n = read(client_fd, &raw[0], raw.size() - 1);
-    if (n <= 0) {
-        close(client_fd);
+    if (shedIfHashPoolBusy(respond)) return;
+    handleLogInRequest(req.body, respond);
+}
+
+static void routeRegister(const HttpRequest& req, const RouteParams&, const Responder& respond)
+{
+    if (shedIfHashPoolBusy(respond)) return;
+    handleSignUpRequest(req.body, respond);
+}
+
+static void routeLogout(const HttpRequest& req, const RouteParams&, const Responder& respond)
+{
+    if (req.token.empty()) {
+        respond(401, R"({"success": false, "message": "缺少或无效token"})");
         return;
     }
-    raw.resize(n);
+    handleLogOutRequest(req.token, respond);
+}
 
-    HttpRequest req;
-    if (!parse_http_request(raw, req)) {
-        LOG_ERROR("Failed to parse HTTP request");
-        close(client_fd);
+// 运行指标的访问令牌，ProcWebConnect 在启动工作线程前写入，之后只读
+static std::string g_metricsToken;
+
+// /api/ 整体经 Nginx 对外公开，排队深度、准入拒绝等指标足以让人掐准时机压垮登录，
+// 因此只对携带运维令牌的请求开放，其余一律按未匹配的路由回 404
+static bool metricsAuthorized(const HttpRequest& req)
+{
+    if (g_metricsToken.empty() || req.token.size() != g_metricsToken.size()) return false;
+    return constantTimeEqual(reinterpret_cast<const uint8_t*>(req.token.data()),
+                             reinterpret_cast<const uint8_t*>(g_metricsToken.data()), g_metricsToken.size());
+}
+
+// 运行指标：密码哈希线程池的排队深度、等待时间与准入拒绝数，用户缓存命中率，邮箱过滤器拦截数，访问日志写出/丢弃数
+static void routeMetrics(const HttpRequest& req, const RouteParams&, const Responder& respond)
+{
+    if (!metricsAuthorized(req)) {
+        respond(404, "{\"success\": false, \"message\": \"Not Found\"}");
         return;
     }
-    LOG_DEBUG("Received HTTP request: %s %s", req.method.c_str(), req.path.c_str());
+    HashPool& hashPool = HashPool::instance();
+    ThreadPoolStats hs = hashPool.stats();
+    uint64_t started = hs.submitted - hs.pending;
+    UserCacheStats uc = UserCache::instance().stats();
+    uint64_t lookups = uc.hits + uc.misses;
+    EmailFilterStats ef = EmailFilter::instance().stats();
+    ConnectionPoolStats db = ConnectionPool::instance().stats();
+    char body[2048];
+    size_t n = std::snprintf(body, sizeof(body),
+        "{\"hashPool\": {\"threads\": %zu, \"queueDepth\": %zu, \"peakQueueDepth\": %zu, "
+        "\"submitted\": %llu, \"rejected\": %llu, \"completed\": %llu, "
+        "\"avgWaitUs\": %llu, \"maxWaitUs\": %llu, \"avgRunUs\": %llu, "
+        "\"estimatedWaitUs\": %llu, \"shed\": %llu}, "
+        "\"userCache\": {\"size\": %zu, \"capacity\": %zu, \"hits\": %llu, \"misses\": %llu, "
+        "\"evictions\": %llu, \"hitRate\": %.4f}, "
+        "\"emailFilter\": {\"ready\": %s, \"capacity\": %zu, \"inserted\": %llu, \"rejected\": %llu, \"rescans\": %llu}, "
+        "\"dbPool\": {\"total\": %d, \"idle\": %zu, \"borrows\": %llu, \"steals\": %llu, "
+        "\"validations\": %llu, \"discarded\": %llu, \"waiters\": %d, \"waits\": %llu, "
+        "\"timeouts\": %llu, \"waitHistogramUs\": {",
+        hs.threads, hs.pending, hs.peakPending,
+        static_cast<unsigned long long>(hs.submitted), static_cast<unsigned long long>(hs.rejected),
+        static_cast<unsigned long long>(hs.completed),
+        static_cast<unsigned long long>(started ? hs.totalWaitUs / started : 0),
+        static_cast<unsigned long long>(hs.maxWaitUs),
+        static_cast<unsigned long long>(hs.avgRunUs),
+        static_cast<unsigned long long>(HashPool::estimatedWaitUs(hs)),
+        static_cast<unsigned long long>(hashPool.shedCount()),
+        uc.size, uc.capacity,
+        static_cast<unsigned long long>(uc.hits), static_cast<unsigned long long>(uc.misses),
+        static_cast<unsigned long long>(uc.evictions),
+        lookups ? static_cast<double>(uc.hits) / lookups : 0.0,
+        ef.ready ? "true" : "false", ef.capacity,
+        static_cast<unsigned long long>(ef.inserted), static_cast<unsigned long long>(ef.rejected),
+        static_cast<unsigned long long>(ef.rescans),
+        db.total, db.idle, static_cast<unsigned long long>(db.borrows),
+        static_cast<unsigned long long>(db.steals),
+        static_cast<unsigned long long>(db.validations), static_cast<unsigned long long>(db.discarded),
+        db.waiters, static_cast<unsigned long long>(db.waits), static_cast<unsigned long long>(db.timeouts));
+    // 直方图桶：键为上界（微秒），最后一桶为 +Inf
+    for (size_t i = 0; i < kPoolWaitBuckets && n < sizeof(body); ++i) {
+        if (i + 1 < kPoolWaitBuckets) {
+            n += std::snprintf(body + n, sizeof(body) - n, "%s\"%u\": %llu", i ? ", " : "",
+                               kPoolWaitBucketUs[i], static_cast<unsigned long long>(db.waitHistogram[i]));
+        } else {
+            n += std::snprintf(body + n, sizeof(body) - n, ", \"+Inf\": %llu}}",
+                               static_cast<unsigned long long>(db.waitHistogram[i]));
+        }
+    }
+    AccessLogStats al = AccessLog::instance().stats();
+    if (n < sizeof(body)) {
+        n += std::snprintf(body + n, sizeof(body) - n,
+                           ", \"accessLog\": {\"enabled\": %s, \"written\": %llu, \"dropped\": %llu}}",
+                           AccessLog::instance().enabled() ? "true" : "false",
+                           static_cast<unsigned long long>(al.written),
+                           static_cast<unsigned long long>(al.dropped));
+    }
+    respond(200, std::string_view(body, std::min(n, sizeof(body) - 1)));
+}
+
+// 路由表：新增接口只需在此追加一行；重复或非法定义在编译期报错
+static constexpr RouteDef kRoutes[] = {
+    {HttpMethod::Post, "/api/login",    routeLogin},
+    {HttpMethod::Post, "/api/register", routeRegister},
+    {HttpMethod::Post, "/api/logout",   routeLogout},
+    {HttpMethod::Get,  "/api/metrics",  routeMetrics},
+};
+static_assert(routesAreValid(kRoutes), "invalid or duplicate route in kRoutes");
+
+static const Router g_router(kRoutes);
+
+// 在工作线程中执行：路由分发
+void handle_request(const HttpRequest& req, const Responder& respond)
+{
+    LOG_DEBUG("Received HTTP request: %.*s %.*s",
+              static_cast<int>(req.method.size()), req.method.data(),
+              static_cast<int>(req.path.size()), req.path.data());
     // 可以调试输出 token
     if (!req.token.empty()) {
-        LOG_DEBUG("Token: %s", req.token.c_str());
-    }
-
-    // 构造回调，捕获client_fd
-    auto sendResponse = [client_fd](int statusCode, const std::string& body) {
-        const char* statusText = (statusCode == 200 ? "OK" : (statusCode == 400 ? "Bad Request" : (statusCode == 401 ? "Unauthorized" : "Error")));
-        std::string resp =
-            "HTTP/1.1 " + std::to_string(statusCode) + " " + statusText + "\r\n" +
-            "Content-Type: application/json; charset=utf-8\r\n" +
-            "Content-Length: " + std::to_string(body.size()) + "\r\n" +
-            "Connection: close\r\n" +
-            "\r\n" +
-            body;
-        ::write(client_fd, resp.data(), resp.size());
-        ::close(client_fd);
-    };
+        LOG_DEBUG("Token: %.*s", static_cast<int>(req.token.size()), req.token.data());
+    }
 
-    // 简单路由示例：处理登录
-    if (req.method == "POST" && req.path == "/api/login") {
-        try {
-            handleLogInRequest(req.body, sendResponse);
-            return; // sendResponse 已关闭连接
-        } catch (const std::exception& e) {
-            sendResponse(400, std::string("{\"success\": false, \"message\": \"JSON parse error: ") + e.what() + "\"}");
-            return;
-        }
-    } else if (req.method == "POST" && req.path == "/api/register") {
-        try {
-            handleSignUpRequest(req.body, sendResponse);
-            return; // sendResponse 已关闭连接
-        } catch (const std::exception& e) {
-            sendResponse(400, std::string("{\"success\": false, \"message\": \"JSON parse error: ") + e.what() + "\"}");
-            return;
-        }
-    } else if (req.method == "POST" && req.path == "/api/logout") {
-        if (req.token.empty()) {
-            sendResponse(401, R"({"success": false, "message": "缺少或无效token"})");
-            return;
+    RouteParams params;
+    RouteMatch m = g_router.match(req.method, req.path, params);
+    if (RequestTrace* trace = RequestTrace::current()) trace->routeId = m.routeId;
+    if (m.status == RouteMatch::Status::Found) {
+        m.handler(req, params, respond);
+        return;
+    }
+    if (m.status == RouteMatch::Status::MethodNotAllowed) {
+        char allow[128] = "Allow: ";
+        size_t n = 7;
+        for (size_t i = 0; i < static_cast<size_t>(HttpMethod::Count); ++i) {
+            if (!(m.allowedMethods & (1u << i))) continue;
+            n += std::snprintf(allow + n, sizeof(allow) - n, n > 7 ? ", %s" : "%s",
+                               methodToString(static_cast<HttpMethod>(i)));
         }
-        handleLogOutRequest(req.token, sendResponse);
+        std::snprintf(allow + n, sizeof(allow) - n, "\r\n");
+        respond.send(405, R"({"success": false, "message": "Method Not Allowed"})", allow);
         return;
     }
 
     // 其他未匹配路由，返回404
-    sendResponse(404, "{\"success\": false, \"message\": \"Not Found\"}");
+    respond(404, "{\"success\": false, \"message\": \"Not Found\"}");
 }
-// 主要运行函数
-int ProcWebConnect(int port)
+
+// -------------------- epoll 事件循环 --------------------
+// 监听 fd、客户端 fd 全部由事件循环线程独占（边沿触发）；
+// 读满一条完整请求后交给工作线程池处理，工作线程只生成响应报文，
+// 再通过 eventfd 通知事件循环线程写回，因此连接状态无需加锁。
+// 连接默认保持（HTTP/1.1 keep-alive）：同一连接上的请求严格按顺序处理，
+// 上一条响应写完后再解析缓冲区中的下一条（流水线请求）。
+//
+// 每个连接自带读缓冲区、响应缓冲区与 Arena，均在请求之间复用：
+// 解析结果是指向读缓冲区的视图，处理过程中的临时数据（如请求体中含转义的字符串字段）从 Arena 分配，
+// 响应直接拼进响应缓冲区，稳态下一次请求几乎不触发 malloc。
+
+static const size_t kReadChunk = 8192;
+
+using SteadyClock = std::chrono::steady_clock;
+
+class EpollServer;
+
+struct Connection {
+    EpollServer* server = nullptr;
+    uint64_t id = 0;
+    int fd = -1;
+    int requestCount = 0;       // 已分发的请求数
+    SteadyClock::time_point lastActive;
+    std::list<uint64_t>::iterator idleIt; // 在空闲链表中的位置
+    std::string inBuf;          // 读缓冲区，[inStart, size) 为未处理数据
+    size_t inStart = 0;
+    HttpParser parser;          // 解析状态跨多次 read 保留
+    HttpRequest req;            // 视图指向 inBuf，请求处理期间 inBuf 不会被修改
+    Arena arena;                // 请求生命周期内的临时分配，请求结束时 reset
+    std::string respBuf;        // 响应报文，由工作线程写入、事件循环线程发送
+    size_t outOffset = 0;
+    bool keepAlive = true;      // 本条响应后是否保持连接
+    std::atomic<bool> responded{false}; // 已经回写过响应（工作线程侧）
+
+    // 以下状态只由事件循环线程读写
+    bool busy = false;          // 有请求在途：从分发到响应写完
+    bool taskRunning = false;   // 工作线程中的处理函数尚未返回
+    bool respPosted = false;    // 响应已提交
+    bool writing = false;       // respBuf 正在写回
+    bool peerClosed = false;    // 对端已关闭写方向，不会再有新数据
+    bool broken = false;        // 连接出错或需关闭，等待在途引用释放后回收
+    bool closeAfterWrite = false;
+
+    // 访问日志（开启时）：分段耗时与状态码，响应写完后由事件循环汇总成一条记录
+    uint32_t clientIp = 0;       // IPv4，网络字节序
+    bool traced = false;
+    bool requestStarted = false; // 已收到本条请求的首批字节
+    SteadyClock::time_point requestStart;
+    int64_t parseNs = 0;
+    uint32_t handlerUs = 0;      // 工作线程写入，TaskDone 之后读取
+    int status = 0;              // respondThunk 写入，Response 事件之后读取
+    RequestTrace trace;
+
+    // 工作线程或异步回调仍持有该连接的指针
+    bool inUse() const { return taskRunning || (busy && !respPosted); }
+};
+
+static const char* statusText(int statusCode)
+{
+    switch (statusCode) {
+    case 200: return "OK";
+    case 201: return "Created";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 409: return "Conflict";
+    case 413: return "Payload Too Large";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    default: return "Error";
+    }
+}
+
+static void appendNumber(std::string& out, size_t v)
+{
+    char buf[24];
+    auto r = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, static_cast<size_t>(r.ptr - buf));
+}
+
+// 拼装响应报文到连接自带的缓冲区（容量在请求之间保留）
+static void buildResponse(std::string& out, int statusCode, std::string_view body, bool keepAlive,
+                          std::string_view extraHeaders = std::string_view())
+{
+    out.clear();
+    out.append("HTTP/1.1 ");
+    appendNumber(out, static_cast<size_t>(statusCode));
+    out.push_back(' ');
+    out.append(statusText(statusCode));
+    out.append("\r\nContent-Type: application/json; charset=utf-8\r\nContent-Length: ");
+    appendNumber(out, body.size());
+    out.append(keepAlive ? "\r\nConnection: keep-alive\r\n" : "\r\nConnection: close\r\n");
+    out.append(extraHeaders.data(), extraHeaders.size());
+    out.append("\r\n");
+    out.append(body.data(), body.size());
+}
+
+class EpollServer {
+public:
+    explicit EpollServer(const ServerOptions& options);
+    ~EpollServer();
+
+    int run(int port);
+
+private:
+    static const uint64_t kListenId = 0;
+    static const uint64_t kWakeId = 1;
+
+    enum class EventKind : uint8_t {
+        Response, // Responder 已写好 respBuf
+        TaskDone  // 工作线程中的处理函数已返回
+    };
+    struct Completion {
+        uint64_t connId;
+        EventKind kind;
+    };
+
+    // 任意线程调用：通知事件循环线程
+    void postEvent(uint64_t connId, EventKind kind);
+    // Responder 的回写入口，ctx 为 Connection*
+    static void respondThunk(void* ctx, int statusCode, std::string_view body, std::string_view extraHeaders);
+
+    void handleAccept();
+    void handleRead(Connection& conn);
+    void handleWrite(Connection& conn);
+    void drainCompletions();
+    void tryDispatch(Connection& conn);
+    void completeRequest(Connection& conn);
+    void closeConnection(Connection& conn);
+    void rejectRequest(Connection& conn, int statusCode);
+    void finishRequest(Connection& conn);
+    void recordAccess(Connection& conn, int statusCode, size_t bytesIn);
+    void touch(Connection& conn);
+    void sweepIdle();
+
+    ServerOptions options_;
+    ThreadPool workers_;
+    int epollFd_{-1};
+    int listenFd_{-1};
+    int wakeFd_{-1};
+    uint64_t nextConnId_{2};
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> conns_;
+    // 按最近活跃时间排序（最旧在前），空闲超时检查只需从表头扫描
+    std::list<uint64_t> idleList_;
+
+    std::mutex completionMutex_;
+    std::vector<Completion> completions_;
+    std::vector<Completion> readyScratch_; // 与 completions_ 交换，保留容量
+};
+
+static size_t resolveWorkerCount(const ServerOptions& options)
+{
+    if (options.workerThreads > 0) return static_cast<size_t>(options.workerThreads);
+    unsigned hc = std::thread::hardware_concurrency();
+    return hc ? hc : 4;
+}
+
+EpollServer::EpollServer(const ServerOptions& options)
+    : options_(options), workers_(resolveWorkerCount(options))
+{
+}
+
+EpollServer::~EpollServer()
+{
+    // 先停工作线程，再排空哈希线程池：两者的任务都可能持有 Connection* 并回写响应，
+    // 必须在连接与 eventfd 释放之前全部结束
+    workers_.shutdown();
+    HashPool::instance().shutdown();
+    for (auto& kv : conns_) {
+        ::close(kv.second->fd);
+    }
+    if (listenFd_ >= 0) ::close(listenFd_);
+    if (wakeFd_ >= 0) ::close(wakeFd_);
+    if (epollFd_ >= 0) ::close(epollFd_);
+}
+
+int EpollServer::run(int port)
 {
-    int server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd < 0) {
+    listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) {
         perror("socket");
         return 1;
     }
     int opt = 1;
-    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
     sockaddr_in addr{};
     addr.sin_family = AF_INET;
     addr.sin_addr.s_addr = inet_addr("127.0.0.1");
     addr.sin_port = htons(port);
-    if (bind(server_fd, (sockaddr *)&addr, sizeof(addr)) < 0) {
+    if (bind(listenFd_, (sockaddr *)&addr, sizeof(addr)) < 0) {
         perror("bind");
-        close(server_fd);
         return 1;
     }
-    if (listen(server_fd, 16) < 0) {
+    if (listen(listenFd_, SOMAXCONN) < 0) {
         perror("listen");
-        close(server_fd);
         return 1;
     }
 
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd_ < 0 || wakeFd_ < 0) {
+        perror("epoll/eventfd");
+        return 1;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.u64 = kListenId;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &ev);
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.u64 = kWakeId;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+
+    LOG_INFO("Listening on port %d, workers: %zu, max connections: %d",
+             port, workers_.size(), options_.maxConnections);
+
+    // 空闲检查粒度：超时时间的 1/4，最长 1 秒
+    int tickMs = options_.idleTimeoutMs > 0 ? std::min(1000, std::max(10, options_.idleTimeoutMs / 4)) : -1;
+    std::vector<epoll_event> events(256);
+    while (true) {
+        int n = epoll_wait(epollFd_, events.data(), static_cast<int>(events.size()), tickMs);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            return 1;
+        }
+        if (options_.idleTimeoutMs > 0) sweepIdle();
+        for (int i = 0; i < n; ++i) {
+            uint64_t id = events[i].data.u64;
+            uint32_t what = events[i].events;
+            if (id == kListenId) {
+                handleAccept();
+                continue;
+            }
+            if (id == kWakeId) {
+                drainCompletions();
+                continue;
+            }
+            auto it = conns_.find(id);
+            if (it == conns_.end()) continue;
+            Connection& conn = *it->second;
+            if (what & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(conn);
+                continue;
+            }
+            if (what & (EPOLLIN | EPOLLRDHUP)) {
+                handleRead(conn);
+                // handleRead 可能已回收连接
+                if (conns_.find(id) == conns_.end()) continue;
+            }
+            if (what & EPOLLOUT) {
+                handleWrite(conn);
+            }
+        }
+    }
+    return 0;
+}
+
+void EpollServer::handleAccept()
+{
     while (true) {
         sockaddr_in client_addr{};
         socklen_t client_len = sizeof(client_addr);
-        int client_fd = accept(server_fd, (sockaddr *)&client_addr, &client_len);
-        if (client_fd < 0) {
+        int fd = accept4(listenFd_, (sockaddr *)&client_addr, &client_len,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+            if (errno == EINTR || errno == ECONNABORTED) continue;
             perror("accept");
+            return;
+        }
+        if (static_cast<int>(conns_.size()) >= options_.maxConnections) {
+            LOG_WARN("Too many connections (%zu), rejecting new client", conns_.size());
+            ::close(fd);
             continue;
         }
-        std::thread t(handle_client, client_fd);
-        t.detach();
+        auto conn = std::make_unique<Connection>();
+        conn->server = this;
+        conn->parser = HttpParser(options_.maxHeaderBytes, options_.maxBodyBytes);
+        conn->inBuf.reserve(kReadChunk);
+        conn->respBuf.reserve(512);
+        conn->id = nextConnId_++;
+        conn->fd = fd;
+        conn->clientIp = client_addr.sin_addr.s_addr;
+        conn->lastActive = SteadyClock::now();
+        conn->idleIt = idleList_.insert(idleList_.end(), conn->id);
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.u64 = conn->id;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            perror("epoll_ctl");
+            idleList_.erase(conn->idleIt);
+            ::close(fd);
+            continue;
+        }
+        conns_.emplace(conn->id, std::move(conn));
     }
-    close(server_fd);
-    return 0;
+}
+
+void EpollServer::handleRead(Connection& conn)
+{
+    // 有请求在处理中时不读新数据，内核缓冲区天然形成背压；请求完成后再补读
+    if (conn.busy || conn.broken) return;
+    // 单条请求的最大可能长度；缓冲超过它时解析器必然能给出结论，先停止读取
+    size_t limit = options_.maxHeaderBytes + options_.maxBodyBytes;
+    while (conn.inBuf.size() - conn.inStart <= limit) {
+        // 直接读入缓冲区尾部空闲空间，避免中转拷贝
+        size_t used = conn.inBuf.size();
+        if (conn.inBuf.capacity() - used < kReadChunk / 2) {
+            conn.inBuf.reserve(conn.inBuf.capacity() * 2);
+        }
+        conn.inBuf.resize(conn.inBuf.capacity());
+        ssize_t n = ::read(conn.fd, &conn.inBuf[used], conn.inBuf.size() - used);
+        conn.inBuf.resize(used + (n > 0 ? static_cast<size_t>(n) : 0));
+        if (n > 0) {
+            touch(conn);
+            continue;
+        }
+        if (n == 0) {
+            conn.peerClosed = true;
+            break;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        closeConnection(conn);
+        return;
+    }
+    tryDispatch(conn);
+}
+
+void EpollServer::tryDispatch(Connection& conn)
+{
+    if (conn.busy || conn.broken) return;
+    // 解析耗时只在访问日志开启时计量；请求起点取首批字节到达后的第一次解析
+    bool traced = AccessLog::instance().enabled() && conn.inStart < conn.inBuf.size();
+    SteadyClock::time_point parseStart;
+    if (traced) {
+        parseStart = SteadyClock::now();
+        if (!conn.requestStarted) {
+            conn.requestStarted = true;
+            conn.requestStart = parseStart;
+        }
+    }
+    HttpParser::Result r = conn.parser.parse(conn.inBuf.data() + conn.inStart,
+                                             conn.inBuf.size() - conn.inStart, conn.req);
+    if (traced) {
+        conn.parseNs += std::chrono::duration_cast<std::chrono::nanoseconds>(SteadyClock::now() - parseStart).count();
+    }
+    if (r == HttpParser::Result::Error) {
+        LOG_ERROR("Malformed HTTP request, status %d", conn.parser.errorStatus());
+        rejectRequest(conn, conn.parser.errorStatus());
+        return;
+    }
+    if (r == HttpParser::Result::Incomplete) {
+        // 请求不完整：对端已关闭则不会再有数据
+        if (conn.peerClosed) closeConnection(conn);
+        return;
+    }
+
+    conn.busy = true;
+    conn.traced = conn.requestStarted;
+    conn.taskRunning = true;
+    conn.respPosted = false;
+    conn.responded.store(false, std::memory_order_relaxed);
+    conn.requestCount++;
+    // 对端要求关闭、或已达单连接请求上限时，本条响应后关闭连接
+    conn.keepAlive = wants_keep_alive(conn.req) &&
+                     (options_.maxRequestsPerConnection <= 0 ||
+                      conn.requestCount < options_.maxRequestsPerConnection);
+
+    // 连接在 inUse() 期间不会被回收，工作线程与回调可直接使用指针。
+    // 只捕获两个指针，std::function 走小对象优化，不额外分配。
+    Connection* c = &conn;
+    bool submitted = workers_.submit([this, c]() {
+        Responder respond(c, &EpollServer::respondThunk);
+        {
+            ArenaScope scope(c->arena);
+            RequestTrace::Scope trace(c->traced ? &c->trace : nullptr);
+            SteadyClock::time_point handlerStart;
+            if (c->traced) handlerStart = SteadyClock::now();
+            try {
+                handle_request(c->req, respond);
+            } catch (const std::exception& e) {
+                LOG_ERROR("Unhandled exception in request handler: %s", e.what());
+                if (!c->responded.load(std::memory_order_acquire)) {
+                    respond(500, R"({"success": false, "message": "服务器错误"})");
+                }
+            }
+            if (c->traced) {
+                c->handlerUs = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                    SteadyClock::now() - handlerStart).count());
+            }
+        }
+        postEvent(c->id, EventKind::TaskDone);
+    });
+    if (!submitted) {
+        conn.taskRunning = false;
+        conn.respPosted = true;
+        closeConnection(conn);
+    }
+}
+
+// 可在任意线程调用，且只生效一次
+void EpollServer::respondThunk(void* ctx, int statusCode, std::string_view body, std::string_view extraHeaders)
+{
+    Connection* c = static_cast<Connection*>(ctx);
+    if (c->responded.exchange(true, std::memory_order_acq_rel)) {
+        LOG_ERROR("Response sent twice, status %d ignored", statusCode);
+        return;
+    }
+    c->status = statusCode;
+    buildResponse(c->respBuf, statusCode, body, c->keepAlive, extraHeaders);
+    c->server->postEvent(c->id, EventKind::Response);
+}
+
+void EpollServer::postEvent(uint64_t connId, EventKind kind)
+{
+    {
+        std::lock_guard<std::mutex> lock(completionMutex_);
+        completions_.push_back(Completion{connId, kind});
+    }
+    uint64_t one = 1;
+    ssize_t ignored = ::write(wakeFd_, &one, sizeof(one));
+    (void)ignored;
+}
+
+void EpollServer::drainCompletions()
+{
+    uint64_t cnt;
+    while (::read(wakeFd_, &cnt, sizeof(cnt)) > 0) {
+    }
+    {
+        std::lock_guard<std::mutex> lock(completionMutex_);
+        readyScratch_.swap(completions_);
+    }
+    for (const auto& c : readyScratch_) {
+        auto it = conns_.find(c.connId);
+        if (it == conns_.end()) continue;
+        Connection& conn = *it->second;
+        if (c.kind == EventKind::TaskDone) {
+            conn.taskRunning = false;
+        } else {
+            conn.respPosted = true;
+        }
+        if (conn.broken) {
+            closeConnection(conn); // 在途引用全部释放后才真正回收
+            continue;
+        }
+        if (c.kind == EventKind::Response) {
+            conn.outOffset = 0;
+            conn.writing = true;
+            conn.closeAfterWrite = !conn.keepAlive;
+            touch(conn);
+            handleWrite(conn);
+        } else if (conn.respPosted && !conn.writing) {
+            // 响应先于处理函数返回就已写完
+            completeRequest(conn);
+        }
+    }
+    readyScratch_.clear();
+}
+
+void EpollServer::handleWrite(Connection& conn)
+{
+    if (!conn.writing) return;
+    while (conn.outOffset < conn.respBuf.size()) {
+        ssize_t n = ::write(conn.fd, conn.respBuf.data() + conn.outOffset,
+                            conn.respBuf.size() - conn.outOffset);
+        if (n > 0) {
+            conn.outOffset += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return; // 等待 EPOLLOUT
+        closeConnection(conn);
+        return;
+    }
+    conn.writing = false;
+    conn.outOffset = 0;
+    // 处理函数返回前不复用 Arena 和读缓冲区
+    if (!conn.taskRunning) completeRequest(conn);
+}
+
+// 响应已写完且处理函数已返回：关闭，或继续处理同一连接上的下一条请求
+void EpollServer::completeRequest(Connection& conn)
+{
+    if (conn.traced) recordAccess(conn, conn.status, conn.parser.consumed());
+    if (conn.closeAfterWrite) {
+        closeConnection(conn);
+        return;
+    }
+    finishRequest(conn);
+    // 先处理缓冲区里已有的流水线请求，再补读处理期间到达的数据
+    uint64_t id = conn.id;
+    tryDispatch(conn);
+    auto it = conns_.find(id);
+    if (it != conns_.end() && !it->second->busy) {
+        handleRead(*it->second);
+    }
+}
+
+void EpollServer::closeConnection(Connection& conn)
+{
+    conn.broken = true;
+    if (conn.inUse()) return; // 等工作线程/回调释放后再回收
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, conn.fd, nullptr);
+    ::close(conn.fd);
+    idleList_.erase(conn.idleIt);
+    conns_.erase(conn.id); // conn 在此之后失效
+}
+
+// 丢弃已处理完的请求字节，准备解析下一条
+void EpollServer::finishRequest(Connection& conn)
+{
+    conn.busy = false;
+    conn.traced = false;
+    conn.requestStarted = false;
+    conn.parseNs = 0;
+    conn.handlerUs = 0;
+    conn.status = 0;
+    conn.trace.reset();
+    conn.inStart += conn.parser.consumed();
+    conn.parser.reset();
+    conn.req.clear();
+    conn.arena.reset();
+    if (conn.inStart == conn.inBuf.size()) {
+        conn.inBuf.clear();
+        conn.inStart = 0;
+    } else if (conn.inStart >= kReadChunk) {
+        // 流水线残留数据较多时才搬移，避免每条请求都 memmove
+        conn.inBuf.erase(0, conn.inStart);
+        conn.inStart = 0;
+    }
+}
+
+// 请求非法：直接由事件循环回复错误码并关闭连接
+void EpollServer::rejectRequest(Connection& conn, int statusCode)
+{
+    std::string body = std::string("{\"success\": false, \"message\": \"") + statusText(statusCode) + "\"}";
+    buildResponse(conn.respBuf, statusCode, body, false);
+    if (conn.requestStarted) {
+        conn.requestCount++;
+        recordAccess(conn, statusCode, conn.inBuf.size() - conn.inStart);
+    }
+    conn.outOffset = 0;
+    conn.writing = true;
+    conn.closeAfterWrite = true;
+    handleWrite(conn);
+}
+
+// 汇总本条请求的访问记录，在响应写完（或拒绝请求）时由事件循环调用
+void EpollServer::recordAccess(Connection& conn, int statusCode, size_t bytesIn)
+{
+    auto now = SteadyClock::now();
+    AccessRecord r{};
+    r.startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(conn.requestStart.time_since_epoch()).count();
+    r.clientIp = conn.clientIp;
+    r.status = static_cast<uint16_t>(statusCode);
+    r.method = static_cast<uint8_t>(methodFromString(conn.req.method));
+    r.routeId = conn.trace.routeId;
+    r.connRequest = static_cast<uint32_t>(conn.requestCount);
+    r.bytesIn = static_cast<uint32_t>(bytesIn);
+    r.bytesOut = static_cast<uint32_t>(conn.respBuf.size());
+    r.parseUs = static_cast<uint32_t>(conn.parseNs / 1000);
+    r.handlerUs = conn.handlerUs;
+    r.dbUs = conn.trace.dbUs.load(std::memory_order_relaxed);
+    r.bcryptUs = conn.trace.bcryptUs.load(std::memory_order_relaxed);
+    r.totalUs = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        now - conn.requestStart).count());
+    AccessLog::instance().append(r);
+}
+
+void EpollServer::touch(Connection& conn)
+{
+    conn.lastActive = SteadyClock::now();
+    idleList_.splice(idleList_.end(), idleList_, conn.idleIt);
+}
+
+void EpollServer::sweepIdle()
+{
+    auto deadline = SteadyClock::now() - std::chrono::milliseconds(options_.idleTimeoutMs);
+    while (!idleList_.empty()) {
+        Connection& conn = *conns_.at(idleList_.front());
+        if (conn.lastActive > deadline) break;
+        if (conn.busy || conn.writing || conn.broken) {
+            // 仍在处理或写回中，不算空闲
+            touch(conn);
+            continue;
+        }
+        LOG_DEBUG("Closing idle connection %llu", static_cast<unsigned long long>(conn.id));
+        closeConnection(conn);
+    }
+}
+
+// 主要运行函数
+int ProcWebConnect(int port, const ServerOptions& options)
+{
+    g_metricsToken = options.metricsToken;
+    EpollServer server(options);
+    return server.run(port);
 }
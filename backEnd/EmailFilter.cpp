@@ -0,0 +1,209 @@
+#include "EmailFilter.h"
+#include "MySQLProc.h"
+#include "LogM.h"
+#include <string>
+
+namespace {
+
+// 小写归一化后再哈希，栈上缓冲够放任何合法邮箱（最长 254 字节）
+std::string_view normalizeEmail(std::string_view email, char (&buf)[256])
+{
+    size_t n = email.size() < sizeof(buf) ? email.size() : sizeof(buf);
+    for (size_t i = 0; i < n; ++i) {
+        char c = email[i];
+        buf[i] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+    }
+    return std::string_view(buf, n);
+}
+
+// 后台增量扫描借连接的期限，与连接池默认期限一致；借不到就等下个周期，不与请求抢连接
+constexpr std::chrono::milliseconds kRefreshCheckoutTimeout{50};
+
+} // namespace
+
+BloomFilter::BloomFilter(size_t expected, size_t bitsPerItem)
+{
+    if (expected == 0) expected = 1;
+    if (bitsPerItem == 0) bitsPerItem = 10;
+    uint64_t bits = 64;
+    while (bits < static_cast<uint64_t>(expected) * bitsPerItem) bits <<= 1;
+    bitMask_ = bits - 1;
+    // 最优 k = ln2 * bitsPerItem
+    hashCount_ = static_cast<unsigned>(bitsPerItem * 7 / 10);
+    if (hashCount_ == 0) hashCount_ = 1;
+    size_t words = static_cast<size_t>(bits / 64);
+    words_.reset(new std::atomic<uint64_t>[words]);
+    for (size_t i = 0; i < words; ++i) words_[i].store(0, std::memory_order_relaxed);
+}
+
+uint64_t BloomFilter::hash64(std::string_view key)
+{
+    // FNV-1a 后接 splitmix64 终混，保证高低位都足够随机
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+void BloomFilter::add(std::string_view key)
+{
+    uint64_t h = hash64(key);
+    uint64_t h1 = h & 0xffffffffULL;
+    uint64_t h2 = (h >> 32) | 1;
+    for (unsigned i = 0; i < hashCount_; ++i) {
+        uint64_t bit = (h1 + i * h2) & bitMask_;
+        words_[bit >> 6].fetch_or(1ULL << (bit & 63), std::memory_order_relaxed);
+    }
+}
+
+bool BloomFilter::mightContain(std::string_view key) const
+{
+    uint64_t h = hash64(key);
+    uint64_t h1 = h & 0xffffffffULL;
+    uint64_t h2 = (h >> 32) | 1;
+    for (unsigned i = 0; i < hashCount_; ++i) {
+        uint64_t bit = (h1 + i * h2) & bitMask_;
+        if (!(words_[bit >> 6].load(std::memory_order_relaxed) & (1ULL << (bit & 63)))) return false;
+    }
+    return true;
+}
+
+EmailFilter& EmailFilter::instance()
+{
+    static EmailFilter inst;
+    return inst;
+}
+
+EmailFilter::~EmailFilter()
+{
+    stopRefresher();
+}
+
+bool EmailFilter::build()
+{
+    if (ready()) return true;
+    long long count = CountRegisteredUsers();
+    if (count < 0) {
+        LOG_ERROR("Email filter disabled: cannot count sys_user");
+        return false;
+    }
+    // 预留一倍余量给运行期间的新注册
+    size_t capacity = static_cast<size_t>(count) * 2;
+    if (capacity < 100000) capacity = 100000;
+    auto filter = std::make_unique<BloomFilter>(capacity);
+
+    char buf[256];
+    uint64_t loaded = 0;
+    uint64_t maxId = 0;
+    bool ok = ForEachRegisteredEmail([&](uint64_t id, const std::string& email) {
+        filter->add(normalizeEmail(email, buf));
+        ++loaded;
+        if (id > maxId) maxId = id;
+    });
+    if (!ok) {
+        LOG_ERROR("Email filter disabled: scanning sys_user failed");
+        return false;
+    }
+
+    scanFrom_ = maxId;
+    maxSeenId_ = maxId;
+    capacity_ = capacity;
+    inserted_.store(loaded, std::memory_order_relaxed);
+    owned_ = std::move(filter);
+    filter_.store(owned_.get(), std::memory_order_release);
+    LOG_INFO("Email filter ready: %llu emails, %zu bits", static_cast<unsigned long long>(loaded),
+             owned_->bitCount());
+    return true;
+}
+
+void EmailFilter::startRefresher(std::chrono::milliseconds interval)
+{
+    if (!ready()) return;
+    std::lock_guard<std::mutex> lk(refresherMutex_);
+    if (refresherRunning_) return;
+    refresherRunning_ = true;
+    refresher_ = std::thread([this, interval]() {
+        std::unique_lock<std::mutex> lock(refresherMutex_);
+        while (refresherRunning_) {
+            refresherCv_.wait_for(lock, interval);
+            if (!refresherRunning_) break;
+            lock.unlock();
+            rescan();
+            lock.lock();
+        }
+    });
+}
+
+void EmailFilter::stopRefresher()
+{
+    {
+        std::lock_guard<std::mutex> lk(refresherMutex_);
+        if (!refresherRunning_) return;
+        refresherRunning_ = false;
+    }
+    refresherCv_.notify_all();
+    if (refresher_.joinable()) refresher_.join();
+}
+
+bool EmailFilter::rescan()
+{
+    BloomFilter* filter = filter_.load(std::memory_order_acquire);
+    if (!filter) return false;
+    uint64_t maxId = maxSeenId_;
+    bool ok = ForEachRegisteredEmail([&](uint64_t id, const std::string& email) {
+        // 起点之后、maxSeenId_ 之前的行可能已加入过，重复加入无害，只是不再计数
+        addNormalized(*filter, email, id > maxSeenId_);
+        if (id > maxId) maxId = id;
+    }, scanFrom_, kRefreshCheckoutTimeout);
+    if (!ok) return false;
+    rescans_.fetch_add(1, std::memory_order_relaxed);
+    scanFrom_ = maxSeenId_;
+    maxSeenId_ = maxId;
+    return true;
+}
+
+void EmailFilter::addNormalized(BloomFilter& filter, std::string_view email, bool count)
+{
+    char buf[256];
+    filter.add(normalizeEmail(email, buf));
+    if (!count) return;
+    uint64_t n = inserted_.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (n == capacity_) {
+        LOG_ERROR("Email filter reached its capacity (%zu), false positive rate will rise until restart", capacity_);
+    }
+}
+
+void EmailFilter::add(std::string_view email)
+{
+    BloomFilter* filter = filter_.load(std::memory_order_acquire);
+    if (!filter) return;
+    addNormalized(*filter, email, true);
+}
+
+bool EmailFilter::mightExist(std::string_view email)
+{
+    BloomFilter* filter = filter_.load(std::memory_order_acquire);
+    if (!filter) return true;
+    char buf[256];
+    if (filter->mightContain(normalizeEmail(email, buf))) return true;
+    rejected_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+EmailFilterStats EmailFilter::stats() const
+{
+    EmailFilterStats s;
+    s.ready = ready();
+    s.capacity = capacity_;
+    s.inserted = inserted_.load(std::memory_order_relaxed);
+    s.rejected = rejected_.load(std::memory_order_relaxed);
+    s.rescans = rescans_.load(std::memory_order_relaxed);
+    return s;
+}
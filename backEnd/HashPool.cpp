@@ -0,0 +1,63 @@
+#include "HashPool.h"
+#include "LogM.h"
+
+HashPool& HashPool::instance()
+{
+    static HashPool inst;
+    return inst;
+}
+
+void HashPool::init(int threads, size_t maxPending, int maxWaitMs)
+{
+    HashPool& inst = instance();
+    if (inst.pool_) return;
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency() / 2);
+        if (threads <= 0) threads = 1;
+    }
+    inst.maxPending_ = maxPending;
+    inst.maxWaitUs_ = static_cast<uint64_t>(maxWaitMs > 0 ? maxWaitMs : 0) * 1000;
+    inst.pool_ = std::make_unique<ThreadPool>(static_cast<size_t>(threads), maxPending);
+    LOG_INFO("Hash pool started: %d threads, max pending %zu, wait budget %d ms",
+             threads, maxPending, maxWaitMs);
+}
+
+uint64_t HashPool::estimatedWaitUs(const ThreadPoolStats& s)
+{
+    if (s.threads == 0) return 0;
+    // 前面排队的任务按线程数分批完成，再加上自身的一次计算
+    return (s.pending / s.threads + 1) * s.avgRunUs;
+}
+
+bool HashPool::admit(int* retryAfterSec)
+{
+    if (!pool_) return true; // 未初始化时由 submit 失败处理
+    ThreadPoolStats s = pool_->stats();
+    uint64_t waitUs = estimatedWaitUs(s);
+    bool full = maxPending_ != 0 && s.pending >= maxPending_;
+    if (!full && (maxWaitUs_ == 0 || waitUs <= maxWaitUs_)) return true;
+
+    shed_.fetch_add(1, std::memory_order_relaxed);
+    if (retryAfterSec) {
+        uint64_t sec = (waitUs + 999999) / 1000000;
+        *retryAfterSec = sec < 1 ? 1 : static_cast<int>(sec);
+    }
+    return false;
+}
+
+bool HashPool::submit(std::function<void()> task)
+{
+    if (!pool_) return false;
+    return pool_->submit(std::move(task));
+}
+
+ThreadPoolStats HashPool::stats()
+{
+    if (!pool_) return ThreadPoolStats();
+    return pool_->stats();
+}
+
+void HashPool::shutdown()
+{
+    if (pool_) pool_->shutdown();
+}
@@ -0,0 +1,273 @@
+#include "HttpParser.h"
+#include "HttpScan.h"
+#include <cstring>
+
+static inline bool isOws(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+static inline char asciiLower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b)
+{
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (asciiLower(a[i]) != asciiLower(b[i])) return false;
+    }
+    return true;
+}
+
+HeaderId headerIdOf(std::string_view name)
+{
+    // 先按长度分流，每个长度最多一次比较
+    switch (name.size()) {
+    case 5:
+        if (equalsIgnoreCase(name, "Token")) return HeaderId::Token;
+        break;
+    case 10:
+        if (equalsIgnoreCase(name, "Connection")) return HeaderId::Connection;
+        break;
+    case 12:
+        if (equalsIgnoreCase(name, "Content-Type")) return HeaderId::ContentType;
+        break;
+    case 13:
+        if (equalsIgnoreCase(name, "Authorization")) return HeaderId::Authorization;
+        break;
+    case 14:
+        if (equalsIgnoreCase(name, "Content-Length")) return HeaderId::ContentLength;
+        break;
+    case 17:
+        if (equalsIgnoreCase(name, "Transfer-Encoding")) return HeaderId::TransferEncoding;
+        break;
+    default:
+        break;
+    }
+    return HeaderId::Other;
+}
+
+// -------------------- HttpHeaders --------------------
+
+std::string_view HttpHeaders::get(HeaderId id) const
+{
+    uint8_t slot = known_[static_cast<size_t>(id)];
+    if (id == HeaderId::Other || slot == 0) return std::string_view();
+    return items_[slot - 1].value;
+}
+
+std::string_view HttpHeaders::get(std::string_view name) const
+{
+    HeaderId id = headerIdOf(name);
+    if (id != HeaderId::Other) return get(id);
+    for (size_t i = 0; i < count_; ++i) {
+        if (items_[i].id == HeaderId::Other && equalsIgnoreCase(items_[i].name, name)) {
+            return items_[i].value;
+        }
+    }
+    return std::string_view();
+}
+
+void HttpHeaders::clear()
+{
+    count_ = 0;
+    std::memset(known_, 0, sizeof(known_));
+}
+
+void HttpHeaders::rebase(const char* oldBase, const char* newBase)
+{
+    for (size_t i = 0; i < count_; ++i) {
+        HttpHeader& h = items_[i];
+        h.name = std::string_view(newBase + (h.name.data() - oldBase), h.name.size());
+        h.value = std::string_view(newBase + (h.value.data() - oldBase), h.value.size());
+    }
+}
+
+void HttpRequest::clear()
+{
+    method = path = version = body = token = std::string_view();
+    headers.clear();
+}
+
+// -------------------- HttpParser --------------------
+
+HttpParser::HttpParser(size_t maxHeaderBytes, size_t maxBodyBytes)
+    : maxHeaderBytes_(maxHeaderBytes), maxBodyBytes_(maxBodyBytes)
+{
+}
+
+void HttpParser::reset()
+{
+    state_ = State::RequestLine;
+    base_ = nullptr;
+    lineStart_ = scanPos_ = 0;
+    colonPos_ = kNoColon;
+    bodyStart_ = contentLength_ = consumed_ = 0;
+    errorStatus_ = 0;
+}
+
+HttpParser::Result HttpParser::fail(int status)
+{
+    errorStatus_ = status;
+    return Result::Error;
+}
+
+static std::string_view rebaseView(std::string_view v, const char* oldBase, const char* newBase)
+{
+    if (v.data() == nullptr) return v;
+    return std::string_view(newBase + (v.data() - oldBase), v.size());
+}
+
+HttpParser::Result HttpParser::parse(const char* data, size_t len, HttpRequest& req)
+{
+    if (state_ == State::Done) return Result::Complete;
+    if (errorStatus_) return Result::Error;
+
+    if (state_ == State::RequestLine && lineStart_ == 0 && scanPos_ == 0) {
+        req.clear();
+    } else if (base_ != data) {
+        // 两次调用之间缓冲区被搬移（扩容或丢弃已处理数据），平移已写入的视图
+        req.method = rebaseView(req.method, base_, data);
+        req.path = rebaseView(req.path, base_, data);
+        req.version = rebaseView(req.version, base_, data);
+        req.headers.rebase(base_, data);
+    }
+    base_ = data;
+
+    // 请求行与头部：逐行推进，行尾允许 "\r\n" 或单独 "\n"
+    const char* end = data + len;
+    while (state_ == State::RequestLine || state_ == State::Headers) {
+        if (state_ == State::Headers && colonPos_ == kNoColon) {
+            // 头部行：一次向量化扫描同时定位冒号和行尾
+            const char* q = scanChar2(data + scanPos_, end, ':', '\n');
+            if (q == end) {
+                scanPos_ = len;
+                if (len > maxHeaderBytes_) return fail(431);
+                return Result::Incomplete;
+            }
+            if (*q == ':') {
+                colonPos_ = static_cast<size_t>(q - data);
+                scanPos_ = colonPos_ + 1;
+            }
+        }
+        const char* nl = scanChar(data + scanPos_, end, '\n');
+        if (nl == end) {
+            scanPos_ = len;
+            if (len > maxHeaderBytes_) return fail(431);
+            return Result::Incomplete;
+        }
+        size_t lineEnd = static_cast<size_t>(nl - data);
+        if (lineEnd >= maxHeaderBytes_) return fail(431);
+        size_t next = lineEnd + 1;
+        if (lineEnd > lineStart_ && data[lineEnd - 1] == '\r') --lineEnd;
+
+        if (state_ == State::RequestLine) {
+            // 容忍请求之间多余的空行
+            if (lineEnd > lineStart_) {
+                if (!parseRequestLine(data, lineEnd, req)) return fail(400);
+                state_ = State::Headers;
+            }
+        } else if (lineEnd == lineStart_) {
+            if (req.headers.has(HeaderId::TransferEncoding)) {
+                // 暂不支持分块传输
+                return fail(501);
+            }
+            if (contentLength_ > maxBodyBytes_) return fail(413);
+            bodyStart_ = next;
+            state_ = State::Body;
+        } else if (colonPos_ == kNoColon || !parseHeaderLine(data, lineEnd, req)) {
+            return fail(errorStatus_ ? errorStatus_ : 400);
+        }
+        lineStart_ = scanPos_ = next;
+        colonPos_ = kNoColon;
+    }
+
+    if (len - bodyStart_ < contentLength_) return Result::Incomplete;
+    consumed_ = bodyStart_ + contentLength_;
+    state_ = State::Done;
+    req.body = std::string_view(data + bodyStart_, contentLength_);
+    extractToken(req);
+    return Result::Complete;
+}
+
+bool HttpParser::parseRequestLine(const char* data, size_t lineEnd, HttpRequest& req)
+{
+    // METHOD SP PATH SP VERSION
+    const char* begin = data + lineStart_;
+    const char* end = data + lineEnd;
+    const char* sp1 = static_cast<const char*>(std::memchr(begin, ' ', end - begin));
+    if (!sp1 || sp1 == begin) return false;
+    const char* p = sp1;
+    while (p < end && *p == ' ') ++p;
+    const char* sp2 = static_cast<const char*>(std::memchr(p, ' ', end - p));
+    if (!sp2 || sp2 == p) return false;
+    const char* v = sp2;
+    while (v < end && *v == ' ') ++v;
+    if (end - v < 5 || std::memcmp(v, "HTTP/", 5) != 0) return false;
+
+    req.method = std::string_view(begin, static_cast<size_t>(sp1 - begin));
+    req.path = std::string_view(p, static_cast<size_t>(sp2 - p));
+    req.version = std::string_view(v, static_cast<size_t>(end - v));
+    return true;
+}
+
+bool HttpParser::parseHeaderLine(const char* data, size_t lineEnd, HttpRequest& req)
+{
+    const char* begin = data + lineStart_;
+    const char* colon = data + colonPos_;
+    const char* end = data + lineEnd;
+    if (colon == begin || colon > end) return false;
+    // 字段名与冒号之间不允许空白（RFC 7230 3.2.4）
+    if (isOws(colon[-1])) return false;
+
+    const char* vb = colon + 1;
+    const char* ve = end;
+    while (vb < ve && isOws(*vb)) ++vb;
+    while (ve > vb && isOws(ve[-1])) --ve;
+
+    std::string_view name(begin, static_cast<size_t>(colon - begin));
+    std::string_view value(vb, static_cast<size_t>(ve - vb));
+    HeaderId id = headerIdOf(name);
+
+    if (id == HeaderId::ContentLength) {
+        if (value.empty()) return false;
+        size_t n = 0;
+        for (char c : value) {
+            if (c < '0' || c > '9') return false;
+            if (n > (maxBodyBytes_ - static_cast<size_t>(c - '0')) / 10) {
+                errorStatus_ = 413;
+                return false;
+            }
+            n = n * 10 + static_cast<size_t>(c - '0');
+        }
+        // 多个 Content-Length 必须一致，防止请求走私
+        if (req.headers.has(HeaderId::ContentLength) && n != contentLength_) return false;
+        contentLength_ = n;
+    }
+
+    if (!req.headers.add(name, value, id)) {
+        errorStatus_ = 431;
+        return false;
+    }
+    return true;
+}
+
+void HttpParser::extractToken(HttpRequest& req) const
+{
+    // 优先使用 Authorization: Bearer <token> 形式；否则尝试 Token: <token>
+    std::string_view auth = req.headers.get(HeaderId::Authorization);
+    if (!auth.empty()) {
+        const std::string_view bearerPrefix = "Bearer ";
+        if (auth.size() >= bearerPrefix.size() &&
+            equalsIgnoreCase(auth.substr(0, bearerPrefix.size()), bearerPrefix)) {
+            auth.remove_prefix(bearerPrefix.size());
+            while (!auth.empty() && isOws(auth.front())) auth.remove_prefix(1);
+        }
+        // 若无 Bearer 前缀，直接全部当作 token
+        req.token = auth;
+    } else {
+        req.token = req.headers.get(HeaderId::Token);
+    }
+}
@@ -0,0 +1,93 @@
+#include "HttpScan.h"
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HTTPSCAN_X86 1
+#include <immintrin.h>
+#endif
+
+static const char* scan2Scalar(const char* p, const char* end, char a, char b)
+{
+    for (; p < end; ++p) {
+        if (*p == a || *p == b) return p;
+    }
+    return end;
+}
+
+#ifdef HTTPSCAN_X86
+__attribute__((target("avx2")))
+static const char* scan2Avx2(const char* p, const char* end, char a, char b)
+{
+    const __m256i va = _mm256_set1_epi8(a);
+    const __m256i vb = _mm256_set1_epi8(b);
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(v, va), _mm256_cmpeq_epi8(v, vb));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (mask) return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    // 不足 32 字节的尾部先按 16 字节处理，头部行通常较短，尾部占比不小
+    if (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, _mm256_castsi256_si128(va)),
+                                   _mm_cmpeq_epi8(v, _mm256_castsi256_si128(vb)));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        if (mask) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    return scan2Scalar(p, end, a, b);
+}
+
+__attribute__((target("sse4.2")))
+static const char* scan2Sse42(const char* p, const char* end, char a, char b)
+{
+    // pcmpestri 以 "ab" 为字符集，在 16 字节块中找第一个命中位置
+    const __m128i set = _mm_setr_epi8(a, b, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int idx = _mm_cmpestri(set, 2, v, 16,
+                               _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+        if (idx != 16) return p + idx;
+        p += 16;
+    }
+    return scan2Scalar(p, end, a, b);
+}
+#endif
+
+using Scan2Fn = const char* (*)(const char*, const char*, char, char);
+
+struct ScanImpl {
+    Scan2Fn scan2;
+    const char* name;
+};
+
+static ScanImpl selectImpl()
+{
+#ifdef HTTPSCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return ScanImpl{scan2Avx2, "avx2"};
+    if (__builtin_cpu_supports("sse4.2")) return ScanImpl{scan2Sse42, "sse4.2"};
+#endif
+    return ScanImpl{scan2Scalar, "scalar"};
+}
+
+static const ScanImpl g_scanImpl = selectImpl();
+
+const char* scanChar2(const char* p, const char* end, char a, char b)
+{
+    return g_scanImpl.scan2(p, end, a, b);
+}
+
+const char* scanChar(const char* p, const char* end, char c)
+{
+    // glibc 的 memchr 本身已按 CPU 选择向量化实现
+    if (p >= end) return end;
+    const void* hit = std::memchr(p, c, static_cast<size_t>(end - p));
+    return hit ? static_cast<const char*>(hit) : end;
+}
+
+const char* scanImplName()
+{
+    return g_scanImpl.name;
+}
@@ -0,0 +1,393 @@
+#include "JsonFields.h"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const int kMaxDepth = 64; // 跳过未知字段时允许的最大嵌套层数
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+char* putUtf8(char* out, uint32_t cp)
+{
+    if (cp < 0x80) {
+        *out++ = static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        *out++ = static_cast<char>(0xC0 | (cp >> 6));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        *out++ = static_cast<char>(0xE0 | (cp >> 12));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        *out++ = static_cast<char>(0xF0 | (cp >> 18));
+        *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    return out;
+}
+
+// 顺序读取请求体的游标；所有方法出错时返回 false，错误位置即当前位置
+class JsonReader {
+public:
+    JsonReader(std::string_view s, Arena& arena)
+        : begin_(s.data()), p_(s.data()), end_(s.data() + s.size()), arena_(arena)
+    {
+    }
+
+    size_t offset() const { return static_cast<size_t>(p_ - begin_); }
+    bool atEnd() const { return p_ == end_; }
+    char peek() const { return p_ < end_ ? *p_ : '\0'; }
+
+    void skipWhitespace()
+    {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) ++p_;
+    }
+
+    bool consume(char c)
+    {
+        if (p_ == end_ || *p_ != c) return false;
+        ++p_;
+        return true;
+    }
+
+    // 当前位置为 '"'。decode 为 true 时输出字符串内容：无转义直接指向请求体，否则解码到 arena
+    bool readString(std::string_view& out, bool decode)
+    {
+        const char* start = ++p_;
+        bool escaped = false;
+        while (true) {
+            if (p_ == end_) return false;
+            unsigned char c = static_cast<unsigned char>(*p_);
+            if (c == '"') break;
+            if (c == '\\') {
+                if (!checkEscape()) return false;
+                escaped = true;
+            } else if (c < 0x20) {
+                return false;
+            } else if (c < 0x80) {
+                ++p_;
+            } else if (!checkUtf8()) {
+                return false;
+            }
+        }
+        const char* stop = p_++;
+        if (!decode) return true;
+        if (!escaped) {
+            out = std::string_view(start, static_cast<size_t>(stop - start));
+            return true;
+        }
+        out = unescape(start, stop);
+        return true;
+    }
+
+    bool skipValue(int depth)
+    {
+        std::string_view ignored;
+        switch (peek()) {
+        case '"':
+            return readString(ignored, false);
+        case '{':
+            return skipContainer('}', depth);
+        case '[':
+            return skipContainer(']', depth);
+        case 't':
+            return skipLiteral("true", 4);
+        case 'f':
+            return skipLiteral("false", 5);
+        case 'n':
+            return skipLiteral("null", 4);
+        default:
+            return skipNumber();
+        }
+    }
+
+private:
+    // 当前位置为 '\\'；只校验，不解码
+    bool checkEscape()
+    {
+        if (end_ - p_ < 2) return false;
+        char e = p_[1];
+        if (e != 'u') {
+            if (!std::strchr("\"\\/bfnrt", e) || e == '\0') return false;
+            p_ += 2;
+            return true;
+        }
+        uint32_t unit = 0;
+        if (!readHex4(p_ + 2, unit)) return false;
+        p_ += 6;
+        if (unit >= 0xDC00 && unit <= 0xDFFF) return false; // 孤立的低代理项
+        if (unit >= 0xD800 && unit <= 0xDBFF) {
+            uint32_t low = 0;
+            if (end_ - p_ < 6 || p_[0] != '\\' || p_[1] != 'u' || !readHex4(p_ + 2, low)) return false;
+            if (low < 0xDC00 || low > 0xDFFF) return false;
+            p_ += 6;
+        }
+        return true;
+    }
+
+    bool readHex4(const char* s, uint32_t& unit) const
+    {
+        if (end_ - s < 4) return false;
+        unit = 0;
+        for (int i = 0; i < 4; ++i) {
+            int v = hexValue(s[i]);
+            if (v < 0) return false;
+            unit = (unit << 4) | static_cast<uint32_t>(v);
+        }
+        return true;
+    }
+
+    // 当前位置为多字节 UTF-8 序列的首字节（拒绝过长编码与代理项）
+    bool checkUtf8()
+    {
+        unsigned char c = static_cast<unsigned char>(*p_);
+        size_t len;
+        unsigned char lo = 0x80, hi = 0xBF; // 第二字节的合法范围
+        if (c >= 0xC2 && c <= 0xDF) {
+            len = 2;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            len = 3;
+            if (c == 0xE0) lo = 0xA0;
+            if (c == 0xED) hi = 0x9F;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            len = 4;
+            if (c == 0xF0) lo = 0x90;
+            if (c == 0xF4) hi = 0x8F;
+        } else {
+            return false;
+        }
+        if (static_cast<size_t>(end_ - p_) < len) return false;
+        unsigned char c1 = static_cast<unsigned char>(p_[1]);
+        if (c1 < lo || c1 > hi) return false;
+        for (size_t i = 2; i < len; ++i) {
+            if ((static_cast<unsigned char>(p_[i]) & 0xC0) != 0x80) return false;
+        }
+        p_ += len;
+        return true;
+    }
+
+    // [start, stop) 已校验过；解码结果不会比原文长
+    std::string_view unescape(const char* start, const char* stop)
+    {
+        char* buf = static_cast<char*>(arena_.allocate(static_cast<size_t>(stop - start), 1));
+        char* out = buf;
+        for (const char* s = start; s < stop;) {
+            if (*s != '\\') {
+                *out++ = *s++;
+                continue;
+            }
+            char e = s[1];
+            s += 2;
+            switch (e) {
+            case 'b': *out++ = '\b'; break;
+            case 'f': *out++ = '\f'; break;
+            case 'n': *out++ = '\n'; break;
+            case 'r': *out++ = '\r'; break;
+            case 't': *out++ = '\t'; break;
+            case 'u': {
+                uint32_t cp = 0;
+                readHex4(s, cp);
+                s += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    uint32_t low = 0;
+                    readHex4(s + 2, low);
+                    s += 6;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                }
+                out = putUtf8(out, cp);
+                break;
+            }
+            default: *out++ = e; break; // " \ /
+            }
+        }
+        return std::string_view(buf, static_cast<size_t>(out - buf));
+    }
+
+    bool skipContainer(char close, int depth)
+    {
+        if (depth >= kMaxDepth) return false;
+        ++p_;
+        skipWhitespace();
+        if (consume(close)) return true;
+        while (true) {
+            if (close == '}') {
+                std::string_view ignored;
+                if (peek() != '"' || !readString(ignored, false)) return false;
+                skipWhitespace();
+                if (!consume(':')) return false;
+                skipWhitespace();
+            }
+            if (!skipValue(depth + 1)) return false;
+            skipWhitespace();
+            if (consume(close)) return true;
+            if (!consume(',')) return false;
+            skipWhitespace();
+        }
+    }
+
+    bool skipLiteral(const char* lit, size_t n)
+    {
+        if (static_cast<size_t>(end_ - p_) < n || std::memcmp(p_, lit, n) != 0) return false;
+        p_ += n;
+        return true;
+    }
+
+    // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+    bool skipNumber()
+    {
+        auto digits = [this]() {
+            const char* s = p_;
+            while (p_ < end_ && *p_ >= '0' && *p_ <= '9') ++p_;
+            return p_ > s;
+        };
+        consume('-');
+        if (consume('0')) {
+            // 前导 0 后不能再跟数字
+        } else if (!digits()) {
+            return false;
+        }
+        if (consume('.') && !digits()) return false;
+        if (peek() == 'e' || peek() == 'E') {
+            ++p_;
+            if (!consume('+')) consume('-');
+            if (!digits()) return false;
+        }
+        return true;
+    }
+
+    const char* begin_;
+    const char* p_;
+    const char* end_;
+    Arena& arena_;
+};
+
+JsonFieldResult syntaxError(const JsonReader& reader)
+{
+    JsonFieldResult r;
+    r.error = JsonFieldError::Syntax;
+    r.offset = reader.offset();
+    return r;
+}
+
+} // namespace
+
+JsonFieldResult decodeStringFields(std::string_view body, JsonStringField* fields, size_t count, Arena& arena)
+{
+    JsonReader reader(body, arena);
+    reader.skipWhitespace();
+    if (reader.peek() != '{') {
+        // 区分"合法但不是对象"与语法错误
+        if (!reader.skipValue(0)) return syntaxError(reader);
+        reader.skipWhitespace();
+        if (!reader.atEnd()) return syntaxError(reader);
+        JsonFieldResult r;
+        r.error = JsonFieldError::NotObject;
+        return r;
+    }
+
+    reader.consume('{');
+    reader.skipWhitespace();
+    if (!reader.consume('}')) {
+        while (true) {
+            std::string_view key;
+            if (reader.peek() != '"' || !reader.readString(key, true)) return syntaxError(reader);
+            reader.skipWhitespace();
+            if (!reader.consume(':')) return syntaxError(reader);
+            reader.skipWhitespace();
+
+            JsonStringField* target = nullptr;
+            for (size_t i = 0; i < count; ++i) {
+                if (fields[i].name == key) {
+                    target = &fields[i];
+                    break;
+                }
+            }
+            if (target && reader.peek() == '"') {
+                if (!reader.readString(target->value, true)) return syntaxError(reader);
+                target->found = true;
+                target->isString = true;
+            } else {
+                if (!reader.skipValue(1)) return syntaxError(reader);
+                if (target) {
+                    target->found = true;
+                    target->isString = false;
+                }
+            }
+
+            reader.skipWhitespace();
+            if (reader.consume('}')) break;
+            if (!reader.consume(',')) return syntaxError(reader);
+            reader.skipWhitespace();
+        }
+    }
+    reader.skipWhitespace();
+    if (!reader.atEnd()) return syntaxError(reader);
+
+    JsonFieldResult r;
+    for (size_t i = 0; i < count; ++i) {
+        if (!fields[i].found || !fields[i].isString) {
+            r.error = fields[i].found ? JsonFieldError::WrongType : JsonFieldError::MissingField;
+            r.field = fields[i].name;
+            return r;
+        }
+    }
+    return r;
+}
+
+size_t formatJsonFieldError(const JsonFieldResult& result, char* out, size_t cap)
+{
+    int n = 0;
+    int fieldLen = static_cast<int>(result.field.size());
+    switch (result.error) {
+    case JsonFieldError::Ok:
+        n = std::snprintf(out, cap, R"({"success": true})");
+        break;
+    case JsonFieldError::Syntax:
+        n = std::snprintf(out, cap, R"({"success": false, "message": "JSON 格式错误（位置 %zu）"})", result.offset);
+        break;
+    case JsonFieldError::NotObject:
+        n = std::snprintf(out, cap, R"({"success": false, "message": "请求体必须是 JSON 对象"})");
+        break;
+    case JsonFieldError::MissingField:
+        n = std::snprintf(out, cap, R"({"success": false, "message": "缺少字段 %.*s"})", fieldLen, result.field.data());
+        break;
+    case JsonFieldError::WrongType:
+        n = std::snprintf(out, cap, R"({"success": false, "message": "字段 %.*s 必须是字符串"})",
+                          fieldLen, result.field.data());
+        break;
+    }
+    if (n < 0) return 0;
+    return static_cast<size_t>(n) < cap ? static_cast<size_t>(n) : cap - 1;
+}
+
+JsonFieldResult decodeLoginBody(std::string_view body, Arena& arena, LoginBody& out)
+{
+    JsonStringField fields[2];
+    fields[0].name = "email";
+    fields[1].name = "password";
+    JsonFieldResult r = decodeStringFields(body, fields, 2, arena);
+    out.email = fields[0].value;
+    out.password = fields[1].value;
+    return r;
+}
+
+JsonFieldResult decodeSignUpBody(std::string_view body, Arena& arena, SignUpBody& out)
+{
+    JsonStringField fields[3];
+    fields[0].name = "name";
+    fields[1].name = "email";
+    fields[2].name = "password";
+    JsonFieldResult r = decodeStringFields(body, fields, 3, arena);
+    out.name = fields[0].value;
+    out.email = fields[1].value;
+    out.password = fields[2].value;
+    return r;
+}
@@ -1,11 +1,25 @@
 #include "MySQLProc.h"
+#include <algorithm>
 #include <atomic>
 #include <iostream>
+#include <sched.h>
 #include <cppconn/statement.h>
 #include <cppconn/resultset.h>
 #include "LogM.h"
+#include "UserCache.h"
+#include "EmailFilter.h"
 using namespace std;
 
+// 与 StmtId 一一对应
+static const char* const kStatementSql[] = {
+    "INSERT INTO sys_user (username, email, password_hash) VALUES (?, ?, ?)",
+    "SELECT username AS name, email, password_hash FROM sys_user WHERE email = ?",
+    "SELECT COUNT(*) FROM sys_user",
+    "SELECT id, email FROM sys_user WHERE id > ? ORDER BY id LIMIT ?",
+};
+static_assert(sizeof(kStatementSql) / sizeof(kStatementSql[0]) == static_cast<size_t>(StmtId::Count),
+              "kStatementSql must match StmtId");
+
 std::string GetInitName()
 {
     static atomic<int> defaultName = 900001;
@@ -16,19 +30,21 @@ std::string GetInitName()
 SignUpResult GetSignUpResult(const UserInfo &userInfo)
 {
     ConnectionPoolAgent dbAgent(&ConnectionPool::instance());
+    if (!dbAgent) {
+        return SignUpResult::PoolTimeout;
+    }
     try {
-        // 使用预处理语句防止SQL注入
-        std::unique_ptr<sql::PreparedStatement> pstmt(
-            dbAgent->prepareStatement(
-                "INSERT INTO sys_user (username, email, password_hash) VALUES (?, ?, ?)"
-            )
-        );
-        pstmt->setString(1, userInfo.name);
-        pstmt->setString(2, userInfo.email);
-        pstmt->setString(3, userInfo.passwordHash);
-
-        int affectedRows = pstmt->executeUpdate();
+        // 使用预处理语句防止SQL注入（连接创建时已 prepare）
+        sql::PreparedStatement& pstmt = dbAgent.statement(StmtId::InsertUser);
+        pstmt.setString(1, userInfo.name);
+        pstmt.setString(2, userInfo.email);
+        pstmt.setString(3, userInfo.passwordHash);
+
+        int affectedRows = pstmt.executeUpdate();
         if (affectedRows == 1) {
+            // 该邮箱此前若被缓存过（例如并发注册），以数据库为准
+            UserCache::instance().invalidate(userInfo.email);
+            EmailFilter::instance().add(userInfo.email);
             return SignUpResult::Success;
         } else {
             return SignUpResult::DbError;
@@ -36,6 +52,8 @@ SignUpResult GetSignUpResult(const UserInfo &userInfo)
     } catch (sql::SQLException &e) {
         // 处理重复邮箱错误（MySQL错误码1062）
         if (e.getErrorCode() == 1062 || std::string(e.getSQLStateCStr()) == "23000") {
+            // 可能是其他进程注册的，顺便补进过滤器
+            EmailFilter::instance().add(userInfo.email);
             return SignUpResult::EmailExists;
         } else {
             cerr << "SQL Error: " << e.what() << ", Error Code: " << e.getErrorCode() << endl;
@@ -45,22 +63,34 @@ SignUpResult GetSignUpResult(const UserInfo &userInfo)
     return SignUpResult::DbError;
 }
 
-UserInfo QueryUserInfoByEmail(const std::string &email)
+UserInfo QueryUserInfoByEmail(const std::string &email, bool* poolTimeout)
 {
-    ConnectionPoolAgent dbAgent(&ConnectionPool::instance());
     UserInfo userInfo;
+    // 先查缓存，命中则不借连接
+    if (UserCache::instance().get(email, userInfo)) {
+        return userInfo;
+    }
+    // 过滤器判定一定未注册的邮箱直接返回空，撞库流量不占用连接池
+    if (!EmailFilter::instance().mightExist(email)) {
+        return userInfo;
+    }
+
+    ConnectionPoolAgent dbAgent(&ConnectionPool::instance());
+    if (!dbAgent) {
+        if (poolTimeout) *poolTimeout = true;
+        return userInfo;
+    }
 
     try {
-        std::unique_ptr<sql::PreparedStatement> pstmt(
-            dbAgent->prepareStatement("SELECT name, email, password_hash FROM sys_user WHERE email = ?")
-        );
-        pstmt->setString(1, email);
+        sql::PreparedStatement& pstmt = dbAgent.statement(StmtId::QueryUserByEmail);
+        pstmt.setString(1, email);
 
-        std::unique_ptr<sql::ResultSet> resultSet(pstmt->executeQuery());
+        std::unique_ptr<sql::ResultSet> resultSet(pstmt.executeQuery());
         if (resultSet->next()) {
             userInfo.name = resultSet->getString("name");
             userInfo.email = resultSet->getString("email");
             userInfo.passwordHash = resultSet->getString("password_hash");
+            UserCache::instance().put(userInfo);
         }
     } catch (sql::SQLException &e) {
         LOG_ERROR("SQL Error: %s, Error Code: %d", e.what(), e.getErrorCode());
@@ -69,6 +99,147 @@ UserInfo QueryUserInfoByEmail(const std::string &email)
     return userInfo;
 }
 
+long long CountRegisteredUsers()
+{
+    ConnectionPoolAgent dbAgent(&ConnectionPool::instance(), kStartupCheckoutTimeout);
+    if (!dbAgent) {
+        LOG_ERROR("CountRegisteredUsers: no database connection available");
+        return -1;
+    }
+    try {
+        std::unique_ptr<sql::ResultSet> resultSet(dbAgent.statement(StmtId::CountUsers).executeQuery());
+        if (resultSet->next()) {
+            return static_cast<long long>(resultSet->getInt64(1));
+        }
+    } catch (sql::SQLException &e) {
+        LOG_ERROR("SQL Error: %s, Error Code: %d", e.what(), e.getErrorCode());
+    }
+    return -1;
+}
+
+bool ForEachRegisteredEmail(const std::function<void(uint64_t id, const std::string& email)>& visit,
+                            uint64_t afterId, std::chrono::milliseconds checkoutTimeout)
+{
+    // 按主键分页（keyset），每批只在内存中保留一页结果
+    constexpr int kPageSize = 10000;
+    ConnectionPoolAgent dbAgent(&ConnectionPool::instance(), checkoutTimeout);
+    if (!dbAgent) {
+        LOG_ERROR("ForEachRegisteredEmail: no database connection available");
+        return false;
+    }
+    try {
+        sql::PreparedStatement& pstmt = dbAgent.statement(StmtId::ScanUserEmails);
+        uint64_t lastId = afterId;
+        while (true) {
+            pstmt.setUInt64(1, lastId);
+            pstmt.setInt(2, kPageSize);
+            std::unique_ptr<sql::ResultSet> resultSet(pstmt.executeQuery());
+            int rows = 0;
+            while (resultSet->next()) {
+                lastId = resultSet->getUInt64(1);
+                visit(lastId, resultSet->getString(2));
+                ++rows;
+            }
+            if (rows < kPageSize) break;
+        }
+    } catch (sql::SQLException &e) {
+        LOG_ERROR("SQL Error: %s, Error Code: %d", e.what(), e.getErrorCode());
+        return false;
+    }
+    return true;
+}
+
+bool InsertTokenRevocation(uint64_t nonce, uint32_t expireAt, bool* poolTimeout)
+{
+    ConnectionPoolAgent dbAgent(&ConnectionPool::instance());
+    if (!dbAgent) {
+        if (poolTimeout) *poolTimeout = true;
+        return false;
+    }
+    try {
+        std::unique_ptr<sql::PreparedStatement> pstmt(dbAgent->prepareStatement(
+            "INSERT IGNORE INTO sys_token_revocation (nonce, expire_at) VALUES (?, ?)"));
+        pstmt->setUInt64(1, nonce);
+        pstmt->setUInt64(2, expireAt);
+        pstmt->executeUpdate();
+        return true;
+    } catch (sql::SQLException &e) {
+        LOG_ERROR("SQL Error: %s, Error Code: %d", e.what(), e.getErrorCode());
+        return false;
+    }
+}
+
+bool ForEachTokenRevocation(uint64_t afterId, uint32_t now,
+                            const std::function<void(const TokenRevocationRow&)>& visit)
+{
+    constexpr int kPageSize = 10000;
+    ConnectionPoolAgent dbAgent(&ConnectionPool::instance(), kStartupCheckoutTimeout);
+    if (!dbAgent) {
+        LOG_ERROR("ForEachTokenRevocation: no database connection available");
+        return false;
+    }
+    try {
+        std::unique_ptr<sql::PreparedStatement> pstmt(dbAgent->prepareStatement(
+            "SELECT id, nonce, expire_at FROM sys_token_revocation "
+            "WHERE id > ? AND expire_at > ? ORDER BY id LIMIT ?"));
+        TokenRevocationRow row;
+        row.id = afterId;
+        while (true) {
+            pstmt->setUInt64(1, row.id);
+            pstmt->setUInt64(2, now);
+            pstmt->setInt(3, kPageSize);
+            std::unique_ptr<sql::ResultSet> resultSet(pstmt->executeQuery());
+            int rows = 0;
+            while (resultSet->next()) {
+                row.id = resultSet->getUInt64(1);
+                row.nonce = resultSet->getUInt64(2);
+                row.expireAt = static_cast<uint32_t>(resultSet->getUInt64(3));
+                visit(row);
+                ++rows;
+            }
+            if (rows < kPageSize) break;
+        }
+    } catch (sql::SQLException &e) {
+        LOG_ERROR("SQL Error: %s, Error Code: %d", e.what(), e.getErrorCode());
+        return false;
+    }
+    return true;
+}
+
+long long PurgeExpiredTokenRevocations(uint32_t now, int limit)
+{
+    ConnectionPoolAgent dbAgent(&ConnectionPool::instance());
+    if (!dbAgent) return -1;
+    try {
+        std::unique_ptr<sql::PreparedStatement> pstmt(dbAgent->prepareStatement(
+            "DELETE FROM sys_token_revocation WHERE expire_at <= ? LIMIT ?"));
+        pstmt->setUInt64(1, now);
+        pstmt->setInt(2, limit);
+        return pstmt->executeUpdate();
+    } catch (sql::SQLException &e) {
+        LOG_ERROR("SQL Error: %s, Error Code: %d", e.what(), e.getErrorCode());
+        return -1;
+    }
+}
+
+sql::PreparedStatement& PooledConnection::statement(StmtId id)
+{
+    std::unique_ptr<sql::PreparedStatement>& stmt = statements[static_cast<size_t>(id)];
+    if (!stmt) {
+        // 建连时 prepare 失败的语句在此重试，失败抛出的 sql::SQLException 由调用方照常处理
+        stmt.reset(conn->prepareStatement(kStatementSql[static_cast<size_t>(id)]));
+    }
+    return *stmt;
+}
+
+void PooledConnection::close()
+{
+    for (auto& stmt : statements) {
+        stmt.reset();
+    }
+    conn.reset();
+}
+
 // -------------------- 单例相关实现 --------------------
 ConnectionPool& ConnectionPool::instance() {
     static ConnectionPool inst; // Meyers Singleton
@@ -80,32 +251,58 @@ void ConnectionPool::init(const std::string& host,
                           const std::string& password,
                           const std::string& database,
                           int maxConnections,
-                          int minConnections) {
+                          int minConnections,
+                          int idleCheckMs,
+                          int checkoutTimeoutMs) {
     ConnectionPool& inst = instance();
     std::lock_guard<std::mutex> lock(inst.mutex_);
     if (inst.isRunning_) {
         // 已经初始化过，直接返回
         return;
     }
-    inst.maxConnections_ = maxConnections;
-    inst.minConnections_ = minConnections;
+    inst.maxConnections_ = std::max(maxConnections, 1);
+    inst.minConnections_ = std::min(minConnections, inst.maxConnections_);
+    inst.idleCheck_ = std::chrono::milliseconds(idleCheckMs);
+    inst.checkoutTimeout_ = std::chrono::milliseconds(checkoutTimeoutMs);
     inst.currentConnections_ = 0;
-    inst.isRunning_ = true;
     inst.host_ = host;
     inst.user_ = user;
     inst.password_ = password;
     inst.database_ = database;
 
+    // 槽位一次性分配，之后借还只在空闲链表间移动指针
+    size_t slotCount = static_cast<size_t>(inst.maxConnections_);
+    inst.slots_.clear();
+    inst.emptySlots_.clear();
+    for (size_t i = 0; i < slotCount; ++i) {
+        inst.slots_.push_back(std::make_unique<PooledConnection>());
+        inst.slots_[i]->slot = static_cast<uint32_t>(i);
+        inst.emptySlots_.push_back(static_cast<uint32_t>(slotCount - 1 - i));
+    }
+    unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+    inst.listCount_ = std::min<size_t>(cpus, slotCount);
+    inst.lists_.reset(new FreeList[inst.listCount_]);
+
     inst.driver_ = sql::mysql::get_mysql_driver_instance();
+    inst.isRunning_ = true;
 
+    // 初始连接同步建立，保证 init 返回后即可借出；其余由补充线程负责
     for (int i = 0; i < inst.minConnections_; ++i) {
+        uint32_t idx = inst.emptySlots_.back();
+        PooledConnection& conn = *inst.slots_[idx];
         try {
-            inst.createConnection();
+            inst.createConnection(conn);
         } catch (const sql::SQLException& e) {
             LOG_ERROR("Failed to create initial connection: %s, code: %d",
                       e.what(), e.getErrorCode());
+            conn.close();
+            continue;
         }
+        inst.emptySlots_.pop_back();
+        inst.currentConnections_++;
+        inst.push(inst.lists_[idx % inst.listCount_], &conn);
     }
+    inst.filler_ = std::thread(&ConnectionPool::fillLoop, &inst);
 }
 // ------------------------------------------------------
 
@@ -113,119 +310,264 @@ ConnectionPool::~ConnectionPool() {
     shutdown();
 }
 
-std::shared_ptr<sql::Connection> ConnectionPool::getConnection()
+ConnectionPool::FreeList& ConnectionPool::homeList()
 {
-    std::unique_lock<std::mutex> lock(mutex_);
-    // 如果没有空闲连接且可以扩展连接池，尝试创建新连接
-    if (connections_.empty() && canExpandPool()) {
-        try {
-            createConnection();
-        } catch (const sql::SQLException& e) {
-            std::cerr << "Failed to create connection on demand: "
-                      << e.what() << ", code: " << e.getErrorCode()
-                      << std::endl;
-        }
+    int cpu = sched_getcpu();
+    if (cpu < 0) {
+        static thread_local size_t fallback = std::hash<std::thread::id>()(std::this_thread::get_id());
+        return lists_[fallback % listCount_];
     }
+    return lists_[static_cast<size_t>(cpu) % listCount_];
+}
 
-    // 等待直到有空闲连接，或者池已经被关闭
-    condVar_.wait(lock, [this]() {
-        return !connections_.empty() || !isRunning_;
-    });
+void ConnectionPool::push(FreeList& list, PooledConnection* conn)
+{
+    uint64_t old = list.head.load();
+    uint64_t next;
+    do {
+        conn->nextFree.store(static_cast<uint32_t>(old), std::memory_order_relaxed);
+        next = (((old >> 32) + 1) << 32) | (conn->slot + 1);
+    } while (!list.head.compare_exchange_weak(old, next));
+    list.idle.fetch_add(1, std::memory_order_relaxed);
+}
 
-    if (!isRunning_) {
-        return nullptr;
+PooledConnection* ConnectionPool::pop(FreeList& list)
+{
+    uint64_t old = list.head.load();
+    while (static_cast<uint32_t>(old) != 0) {
+        // 槽位对象不会释放，读到的 nextFree 若已过期，版本号不同会使 CAS 失败
+        PooledConnection* conn = slots_[static_cast<uint32_t>(old) - 1].get();
+        uint64_t next = (((old >> 32) + 1) << 32) | conn->nextFree.load(std::memory_order_relaxed);
+        if (list.head.compare_exchange_weak(old, next)) {
+            list.idle.fetch_sub(1, std::memory_order_relaxed);
+            return conn;
+        }
     }
+    return nullptr;
+}
 
-    if (!connections_.empty()) {
-        auto conn = connections_.front();
-        connections_.pop();
+PooledConnection* ConnectionPool::tryAcquire()
+{
+    FreeList& home = homeList();
+    if (PooledConnection* conn = pop(home)) {
+        home.borrows.fetch_add(1, std::memory_order_relaxed);
         return conn;
     }
-
-    // 理论上走不到这里
+    size_t start = static_cast<size_t>(&home - lists_.get());
+    for (size_t i = 1; i < listCount_; ++i) {
+        if (PooledConnection* conn = pop(lists_[(start + i) % listCount_])) {
+            home.borrows.fetch_add(1, std::memory_order_relaxed);
+            home.steals.fetch_add(1, std::memory_order_relaxed);
+            return conn;
+        }
+    }
     return nullptr;
 }
 
-void ConnectionPool::returnConnection(std::shared_ptr<sql::Connection> conn)
+size_t ConnectionPool::idleCount() const
 {
-    if (!conn) return;
+    int64_t idle = 0;
+    for (size_t i = 0; i < listCount_; ++i) {
+        idle += lists_[i].idle.load(std::memory_order_relaxed);
+    }
+    return idle > 0 ? static_cast<size_t>(idle) : 0;
+}
 
-    std::unique_lock<std::mutex> lock(mutex_);
-    if (!isRunning_) {
-        // 池已经关闭了，直接丢弃连接并减少计数
-        currentConnections_--;
-        return;
+void ConnectionPool::recordWait(std::chrono::steady_clock::duration waited)
+{
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(waited).count();
+    size_t bucket = 0;
+    while (bucket < kPoolWaitBuckets - 1 && us > kPoolWaitBucketUs[bucket]) {
+        ++bucket;
     }
+    waitHistogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+}
 
-    // 验证连接是否有效
-    if (isConnectionValid(conn)) {
-        connections_.push(conn);
-        condVar_.notify_one();
-    } else {
-        // 连接无效，减少总连接数计数
-        currentConnections_--;
-        std::cerr << "Invalid connection detected and discarded. Current connections: " 
-                  << currentConnections_ << std::endl;
-        
-        // 如果当前连接数低于最小连接数，尝试创建新连接
-        if (currentConnections_ < minConnections_) {
-            try {
-                createConnection();
-                std::cout << "Created new connection to maintain minimum pool size." << std::endl;
-            } catch (const sql::SQLException& e) {
-                std::cerr << "Failed to create replacement connection: "
-                          << e.what() << ", code: " << e.getErrorCode()
-                          << std::endl;
+PooledConnection* ConnectionPool::getConnection(std::chrono::milliseconds timeout)
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+        if (!isRunning_) {
+            return nullptr;
+        }
+        PooledConnection* conn = tryAcquire();
+        if (!conn) {
+            // 慢路径：登记为等待者并唤醒补充线程。持锁期间再次尝试，
+            // 与 returnConnection 的"压栈后加锁通知"配合，不会丢失唤醒
+            auto waitStart = std::chrono::steady_clock::now();
+            waits_.fetch_add(1, std::memory_order_relaxed);
+            std::unique_lock<std::mutex> lock(mutex_);
+            waiters_.fetch_add(1);
+            fillCond_.notify_one();
+            bool timedOut = false;
+            while (isRunning_ && !(conn = tryAcquire())) {
+                if (condVar_.wait_until(lock, deadline) == std::cv_status::timeout) {
+                    // 超时前最后再取一次，避免与归还擦肩而过
+                    conn = tryAcquire();
+                    timedOut = !conn;
+                    break;
+                }
+            }
+            waiters_.fetch_sub(1);
+            lock.unlock();
+            recordWait(std::chrono::steady_clock::now() - waitStart);
+            if (timedOut) {
+                timeouts_.fetch_add(1, std::memory_order_relaxed);
             }
+            if (!conn) {
+                return nullptr;
+            }
+        }
+
+        // 刚归还不久的连接直接使用；只有空闲较久（可能已被服务端 wait_timeout 断开）
+        // 的连接才做一次探活，且在锁外进行，不阻塞其他借还
+        if (std::chrono::steady_clock::now() - conn->lastUsed < idleCheck_) {
+            return conn;
+        }
+        validations_.fetch_add(1, std::memory_order_relaxed);
+        if (isConnectionValid(*conn)) {
+            return conn;
         }
+
+        // 失效连接丢弃后重试，由补充线程重建
+        discarded_.fetch_add(1, std::memory_order_relaxed);
+        discard(conn);
+        LOG_WARN("Stale connection discarded. Current connections: %d",
+                 currentConnections_.load());
     }
 }
 
-void ConnectionPool::shutdown()
+void ConnectionPool::returnConnection(PooledConnection* conn)
 {
-    std::unique_lock<std::mutex> lock(mutex_);
-    if (!isRunning_) return;
+    if (!conn) return;
+
+    // isClosed() 只检查本地状态，不产生网络往返
+    bool closed = !conn->conn || conn->conn->isClosed();
+    if (!isRunning_ || closed) {
+        // 池已经关闭或连接已断开，直接丢弃连接并减少计数
+        if (closed) discarded_.fetch_add(1, std::memory_order_relaxed);
+        discard(conn);
+        return;
+    }
 
-    isRunning_ = false;
+    conn->lastUsed = std::chrono::steady_clock::now();
+    push(homeList(), conn);
+    if (waiters_.load() > 0) {
+        { std::lock_guard<std::mutex> lock(mutex_); }
+        condVar_.notify_one();
+    }
+}
+
+void ConnectionPool::discard(PooledConnection* conn)
+{
+    conn->close();
+    std::lock_guard<std::mutex> lock(mutex_);
+    emptySlots_.push_back(conn->slot);
+    currentConnections_--;
+    fillCond_.notify_one();
+}
 
-    // 清空队列，shared_ptr 离开作用域会自动析构连接
-    while (!connections_.empty()) {
-        connections_.pop();
+void ConnectionPool::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!isRunning_) return;
+        isRunning_ = false;
     }
 
     // 唤醒所有等待中的线程，让它们返回 nullptr
     condVar_.notify_all();
+    fillCond_.notify_all();
+    if (filler_.joinable()) {
+        filler_.join();
+    }
+
+    // 关闭空闲连接；借出中的连接在归还时关闭
+    for (size_t i = 0; i < listCount_; ++i) {
+        while (PooledConnection* conn = pop(lists_[i])) {
+            discard(conn);
+        }
+    }
 }
 
-void ConnectionPool::createConnection() {
-    // 这里可能抛 sql::SQLException，调用处捕获
-    std::shared_ptr<sql::Connection> conn(
-        driver_->connect(host_, user_, password_)
-    );
-    conn->setSchema(database_);
+void ConnectionPool::fillLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (isRunning_) {
+        int total = currentConnections_.load();
+        bool need = !emptySlots_.empty() &&
+                    (total < minConnections_ ||
+                     (waiters_.load() > 0 && idleCount() == 0 && total < maxConnections_));
+        if (!need) {
+            fillCond_.wait_for(lock, std::chrono::seconds(1));
+            continue;
+        }
 
-    connections_.push(conn);
-    currentConnections_++;
+        uint32_t idx = emptySlots_.back();
+        emptySlots_.pop_back();
+        currentConnections_++;
+        lock.unlock();
+
+        // 建连与 prepare 均在锁外进行
+        PooledConnection& conn = *slots_[idx];
+        bool ok = true;
+        try {
+            createConnection(conn);
+        } catch (const sql::SQLException& e) {
+            LOG_ERROR("Failed to create connection: %s, code: %d", e.what(), e.getErrorCode());
+            conn.close();
+            ok = false;
+        }
+        if (ok) {
+            push(lists_[idx % listCount_], &conn);
+        }
+
+        lock.lock();
+        if (ok) {
+            condVar_.notify_one();
+        } else {
+            emptySlots_.push_back(idx);
+            currentConnections_--;
+            // 数据库不可用时退避，避免连续重连
+            fillCond_.wait_for(lock, std::chrono::seconds(1));
+        }
+    }
+}
+
+void ConnectionPool::createConnection(PooledConnection& conn) {
+    // 建连失败会抛 sql::SQLException，调用处捕获
+    conn.conn.reset(driver_->connect(host_, user_, password_));
+    conn.conn->setSchema(database_);
+    for (size_t i = 0; i < static_cast<size_t>(StmtId::Count); ++i) {
+        // 单条语句 prepare 失败只影响用到它的请求，不连累整条连接
+        try {
+            conn.statements[i].reset(conn.conn->prepareStatement(kStatementSql[i]));
+        } catch (const sql::SQLException& e) {
+            conn.statements[i].reset();
+            LOG_ERROR("Prepare statement %zu failed: %s, code: %d", i, e.what(), e.getErrorCode());
+        }
+    }
+    conn.lastUsed = std::chrono::steady_clock::now();
 }
 
-bool ConnectionPool::isConnectionValid(std::shared_ptr<sql::Connection> conn) {
-    if (!conn) return false;
-    
+bool ConnectionPool::isConnectionValid(PooledConnection& conn) {
+    if (!conn.conn) return false;
+
     try {
         // 检查连接是否关闭
-        if (conn->isClosed()) {
+        if (conn.conn->isClosed()) {
             return false;
         }
-        
+
         // 执行一个简单的查询来验证连接
-        std::unique_ptr<sql::Statement> stmt(conn->createStatement());
+        std::unique_ptr<sql::Statement> stmt(conn.conn->createStatement());
         std::unique_ptr<sql::ResultSet> res(stmt->executeQuery("SELECT 1"));
-        
+
         // 如果能执行查询并获得结果，连接是有效的
         return res && res->next();
     } catch (const sql::SQLException& e) {
-        std::cerr << "Connection validation failed: " 
-                  << e.what() << ", code: " << e.getErrorCode() 
+        std::cerr << "Connection validation failed: "
+                  << e.what() << ", code: " << e.getErrorCode()
                   << std::endl;
         return false;
     } catch (...) {
@@ -234,7 +576,22 @@ bool ConnectionPool::isConnectionValid(std::shared_ptr<sql::Connection> conn) {
     }
 }
 
-bool ConnectionPool::canExpandPool() {
-    // 检查是否可以扩展连接池（当前连接数小于最大连接数）
-    return currentConnections_ < maxConnections_;
-}
\ No newline at end of file
+ConnectionPoolStats ConnectionPool::stats()
+{
+    ConnectionPoolStats s;
+    s.total = currentConnections_.load();
+    s.idle = idleCount();
+    for (size_t i = 0; i < listCount_; ++i) {
+        s.borrows += lists_[i].borrows.load(std::memory_order_relaxed);
+        s.steals += lists_[i].steals.load(std::memory_order_relaxed);
+    }
+    s.validations = validations_.load(std::memory_order_relaxed);
+    s.discarded = discarded_.load(std::memory_order_relaxed);
+    s.waiters = waiters_.load(std::memory_order_relaxed);
+    s.waits = waits_.load(std::memory_order_relaxed);
+    s.timeouts = timeouts_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kPoolWaitBuckets; ++i) {
+        s.waitHistogram[i] = waitHistogram_[i].load(std::memory_order_relaxed);
+    }
+    return s;
+}
@@ -0,0 +1,78 @@
+#include "PasswordCrypt.h"
+#include <crypt.h>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <stdexcept>
+
+// crypt_data 约 32KB：放在堆上按线程懒分配，避免所有线程的 TLS 都变大
+static crypt_data& threadCryptData()
+{
+    thread_local std::unique_ptr<crypt_data> data;
+    if (!data) {
+        data = std::make_unique<crypt_data>(); // 值初始化为全 0，满足首次使用要求
+    }
+    return *data;
+}
+
+// 成功返回指向线程私有缓冲区的结果，失败返回 nullptr
+static const char* cryptThreadSafe(const char* key, const char* setting)
+{
+    crypt_data& data = threadCryptData();
+#ifdef CRYPT_OUTPUT_SIZE
+    // libxcrypt：失败时返回 NULL
+    return crypt_rn(key, setting, &data, sizeof(data));
+#else
+    // glibc 自带 crypt_r：失败时返回以 '*' 开头的字符串
+    const char* out = crypt_r(key, setting, &data);
+    return (out && out[0] != '*') ? out : nullptr;
+#endif
+}
+
+static std::string generateBcryptSalt(int cost) {
+    // bcrypt 的“base64”字符集：[./0-9A-Za-z]
+    static const char alphabet[] =
+        "./0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+    if (cost < 4)  cost = 4;
+    if (cost > 31) cost = 31;
+
+    // 前缀：$2b$<cost>$
+    char prefix[8];
+    std::snprintf(prefix, sizeof(prefix), "$2b$%02d$", cost);
+
+    std::string salt = prefix;
+    salt.reserve(salt.size() + 22);
+
+    std::random_device rd;
+    std::uniform_int_distribution<int> dist(0, sizeof(alphabet) - 2); // 去掉末尾 '\0'
+
+    // 22 个随机字符
+    for (int i = 0; i < 22; ++i) {
+        salt.push_back(alphabet[dist(rd)]);
+    }
+
+    return salt;
+}
+
+std::string hashPassword(const std::string& password, int cost)
+{
+    std::string salt = generateBcryptSalt(cost);   // 例如: $2b$12$xxxxxxxxxxxxxxxxxxxxxx
+
+    const char* out = cryptThreadSafe(password.c_str(), salt.c_str());
+    if (!out) {
+        throw std::runtime_error("crypt_r() failed when hashing password");
+    }
+
+    // 形如: $2b$12$...22字节盐...31字节hash...
+    return std::string(out);
+}
+
+bool verifyPassword(const std::string& inputPassword, const std::string& storedHash)
+{
+    // crypt 会从 storedHash 里读出算法 / cost / 盐，然后再算一次
+    const char* out = cryptThreadSafe(inputPassword.c_str(), storedHash.c_str());
+    if (!out) return false;
+
+    return storedHash == out;
+}
@@ -0,0 +1,96 @@
+#include "RevocationSync.h"
+#include "LogM.h"
+#include "MySQLProc.h"
+#include <ctime>
+
+namespace {
+
+// 过期记录的清理周期与单次删除上限；多个进程都会清理，删除本身是幂等的
+constexpr std::chrono::minutes kPurgeInterval{10};
+constexpr int kPurgeBatch = 1000;
+
+uint32_t nowSeconds()
+{
+    return static_cast<uint32_t>(std::time(nullptr));
+}
+
+} // namespace
+
+RevocationSync& RevocationSync::instance()
+{
+    static RevocationSync inst;
+    return inst;
+}
+
+RevocationSync::~RevocationSync()
+{
+    stop();
+}
+
+bool RevocationSync::start(std::chrono::milliseconds interval)
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (running_ || !TokenSigner::enabled()) return running_;
+    bool loaded = pull();
+    if (loaded) {
+        LOG_INFO("Token revocations loaded, last id %llu", static_cast<unsigned long long>(lastMaxId_));
+    } else {
+        LOG_ERROR("Load token revocations failed, will retry in background");
+    }
+    lastPurge_ = std::chrono::steady_clock::now();
+    running_ = true;
+    worker_ = std::thread(&RevocationSync::run, this, interval);
+    return loaded;
+}
+
+void RevocationSync::stop()
+{
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+bool RevocationSync::publish(const TokenSigner::Revocation& r, bool* poolTimeout)
+{
+    if (!InsertTokenRevocation(r.nonce, r.expireAt, poolTimeout)) return false;
+    TokenSigner::instance().applyRevocation(r);
+    return true;
+}
+
+bool RevocationSync::pull()
+{
+    TokenSigner& signer = TokenSigner::instance();
+    uint64_t maxId = lastMaxId_;
+    bool ok = ForEachTokenRevocation(cursor_, nowSeconds(), [&](const TokenRevocationRow& row) {
+        TokenSigner::Revocation r;
+        r.nonce = row.nonce;
+        r.expireAt = row.expireAt;
+        signer.applyRevocation(r);
+        if (row.id > maxId) maxId = row.id;
+    });
+    if (!ok) return false;
+    cursor_ = lastMaxId_;
+    lastMaxId_ = maxId;
+    return true;
+}
+
+void RevocationSync::run(std::chrono::milliseconds interval)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        cv_.wait_for(lock, interval);
+        if (!running_) break;
+        lock.unlock();
+        pull();
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastPurge_ >= kPurgeInterval) {
+            lastPurge_ = now;
+            PurgeExpiredTokenRevocations(nowSeconds(), kPurgeBatch);
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,192 @@
+#include "Router.h"
+#include "LogM.h"
+#include <stdexcept>
+
+HttpMethod methodFromString(std::string_view method)
+{
+    switch (method.size()) {
+    case 3:
+        if (method == "GET") return HttpMethod::Get;
+        if (method == "PUT") return HttpMethod::Put;
+        break;
+    case 4:
+        if (method == "POST") return HttpMethod::Post;
+        if (method == "HEAD") return HttpMethod::Head;
+        break;
+    case 5:
+        if (method == "PATCH") return HttpMethod::Patch;
+        break;
+    case 6:
+        if (method == "DELETE") return HttpMethod::Delete;
+        break;
+    case 7:
+        if (method == "OPTIONS") return HttpMethod::Options;
+        break;
+    default:
+        break;
+    }
+    return HttpMethod::Unknown;
+}
+
+const char* methodToString(HttpMethod method)
+{
+    static const char* const names[] = {"GET", "POST", "PUT", "DELETE", "PATCH", "HEAD", "OPTIONS", "UNKNOWN"};
+    size_t i = static_cast<size_t>(method);
+    return i < sizeof(names) / sizeof(names[0]) ? names[i] : "UNKNOWN";
+}
+
+std::string_view RouteParams::get(std::string_view name) const
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (names[i] == name) return values[i];
+    }
+    return std::string_view();
+}
+
+Router::MethodSet::MethodSet()
+{
+    for (auto& id : routeIds) id = -1;
+}
+
+Router::Router(const RouteDef* routes, size_t count)
+    : routes_(routes, routes + count)
+{
+    trie_.emplace_back(); // 根节点
+    for (size_t i = 0; i < routes_.size(); ++i) {
+        if (isParamPattern(routes_[i].pattern)) addParamRoute(static_cast<int>(i));
+    }
+    buildStaticTable();
+}
+
+void Router::buildStaticTable()
+{
+    std::vector<int> staticIds;
+    for (size_t i = 0; i < routes_.size(); ++i) {
+        if (!isParamPattern(routes_[i].pattern)) staticIds.push_back(static_cast<int>(i));
+    }
+    size_t size = 1;
+    while (size < staticIds.size() * 2) size <<= 1;
+
+    // 换种子直到不同路径互不冲突：查询时只需一次哈希、一次比较
+    for (seed_ = 0;; ++seed_) {
+        if (seed_ > 100000) {
+            // 表大小翻倍后重试；路由数量很小，实际不会走到这里多次
+            size <<= 1;
+            seed_ = 0;
+        }
+        mask_ = size - 1;
+        slots_.assign(size, StaticSlot());
+        bool ok = true;
+        for (int id : staticIds) {
+            const RouteDef& def = routes_[static_cast<size_t>(id)];
+            StaticSlot& slot = slots_[routeHash(def.pattern, seed_) & mask_];
+            if (slot.used && slot.path != def.pattern) {
+                ok = false;
+                break;
+            }
+            slot.used = true;
+            slot.path = def.pattern;
+            size_t m = static_cast<size_t>(def.method);
+            slot.methods.routeIds[m] = static_cast<int16_t>(id);
+            slot.methods.mask |= 1u << m;
+        }
+        if (ok) break;
+    }
+}
+
+void Router::addParamRoute(int routeId)
+{
+    const RouteDef& def = routes_[static_cast<size_t>(routeId)];
+    std::string_view rest = def.pattern.substr(1);
+    int node = 0;
+    while (true) {
+        size_t slash = rest.find('/');
+        std::string_view seg = rest.substr(0, slash);
+        if (!seg.empty() && seg[0] == ':') {
+            std::string_view name = seg.substr(1);
+            TrieNode& cur = trie_[static_cast<size_t>(node)];
+            if (cur.paramChild < 0) {
+                int child = static_cast<int>(trie_.size());
+                trie_[static_cast<size_t>(node)].paramChild = child;
+                trie_[static_cast<size_t>(node)].paramName = name;
+                trie_.emplace_back();
+                node = child;
+            } else {
+                if (cur.paramName != name) {
+                    throw std::logic_error("conflicting path parameter names in route table");
+                }
+                node = cur.paramChild;
+            }
+        } else {
+            auto it = trie_[static_cast<size_t>(node)].children.find(seg);
+            if (it == trie_[static_cast<size_t>(node)].children.end()) {
+                int child = static_cast<int>(trie_.size());
+                trie_[static_cast<size_t>(node)].children.emplace(seg, child);
+                trie_.emplace_back();
+                node = child;
+            } else {
+                node = it->second;
+            }
+        }
+        if (slash == std::string_view::npos) break;
+        rest.remove_prefix(slash + 1);
+    }
+    size_t m = static_cast<size_t>(def.method);
+    trie_[static_cast<size_t>(node)].methods.routeIds[m] = static_cast<int16_t>(routeId);
+    trie_[static_cast<size_t>(node)].methods.mask |= 1u << m;
+}
+
+RouteMatch Router::resolve(const MethodSet& set, HttpMethod method) const
+{
+    RouteMatch r;
+    if (set.mask == 0) return r;
+    int id = set.routeIds[static_cast<size_t>(method)];
+    if (id < 0) {
+        r.status = RouteMatch::Status::MethodNotAllowed;
+        r.allowedMethods = set.mask;
+        return r;
+    }
+    r.status = RouteMatch::Status::Found;
+    r.routeId = id;
+    r.handler = routes_[static_cast<size_t>(id)].handler;
+    return r;
+}
+
+RouteMatch Router::match(std::string_view method, std::string_view path, RouteParams& params) const
+{
+    params.count = 0;
+    size_t q = path.find('?');
+    if (q != std::string_view::npos) path = path.substr(0, q);
+    if (path.empty() || path[0] != '/') return RouteMatch();
+    // 未知方法不会注册任何路由，路径存在时得到 405
+    HttpMethod m = methodFromString(method);
+
+    const StaticSlot& slot = slots_[routeHash(path, seed_) & mask_];
+    if (slot.used && slot.path == path) {
+        return resolve(slot.methods, m);
+    }
+    if (trie_.size() == 1) return RouteMatch();
+
+    // 参数路由：逐段下降，静态段优先于参数段
+    std::string_view rest = path.substr(1);
+    int node = 0;
+    while (true) {
+        size_t slash = rest.find('/');
+        std::string_view seg = rest.substr(0, slash);
+        const TrieNode& cur = trie_[static_cast<size_t>(node)];
+        auto it = cur.children.find(seg);
+        if (it != cur.children.end()) {
+            node = it->second;
+        } else if (cur.paramChild >= 0 && !seg.empty() && params.count < RouteParams::kMaxParams) {
+            params.names[params.count] = cur.paramName;
+            params.values[params.count] = seg;
+            ++params.count;
+            node = cur.paramChild;
+        } else {
+            return RouteMatch();
+        }
+        if (slash == std::string_view::npos) break;
+        rest.remove_prefix(slash + 1);
+    }
+    return resolve(trie_[static_cast<size_t>(node)].methods, m);
+}
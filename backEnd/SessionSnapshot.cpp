@@ -0,0 +1,284 @@
+#include "SessionSnapshot.h"
+#include "LogM.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr char kMagic[8] = {'W', 'S', 'S', 'N', 'A', 'P', '0', '1'};
+constexpr size_t kRecordHeader = 1 + 8 + 2 + 2;
+
+// steady_clock 不能跨进程保存，落盘时换算为 Unix 秒
+int64_t toUnixSeconds(SessionStore::Clock::time_point tp)
+{
+    auto remaining = tp - SessionStore::Clock::now();
+    auto wall = std::chrono::system_clock::now() + std::chrono::duration_cast<std::chrono::system_clock::duration>(remaining);
+    return std::chrono::duration_cast<std::chrono::seconds>(wall.time_since_epoch()).count();
+}
+
+SessionStore::Clock::time_point fromUnixSeconds(int64_t sec)
+{
+    auto wall = std::chrono::system_clock::time_point(std::chrono::seconds(sec));
+    auto remaining = wall - std::chrono::system_clock::now();
+    return SessionStore::Clock::now() + std::chrono::duration_cast<SessionStore::Clock::duration>(remaining);
+}
+
+bool writeAll(int fd, const char* data, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+SessionSnapshot::SessionSnapshot(SessionStore& store)
+    : store_(store)
+{
+}
+
+SessionSnapshot::~SessionSnapshot()
+{
+    stop();
+}
+
+bool SessionSnapshot::appendRecord(std::string& out, RecordType type, int64_t expireAt,
+                                   const std::string& token, const std::string& email)
+{
+    // 长度字段只有 2 字节，超长的会话不落盘（截断后的 key 回放出来就是另一个会话）
+    if (token.size() > UINT16_MAX || email.size() > UINT16_MAX) {
+        LOG_ERROR("Session snapshot skips record type %u: token %zu bytes, email %zu bytes",
+                  static_cast<unsigned>(type), token.size(), email.size());
+        return false;
+    }
+    uint16_t tokenLen = static_cast<uint16_t>(token.size());
+    uint16_t emailLen = static_cast<uint16_t>(email.size());
+    char header[kRecordHeader];
+    header[0] = static_cast<char>(type);
+    std::memcpy(header + 1, &expireAt, 8);
+    std::memcpy(header + 9, &tokenLen, 2);
+    std::memcpy(header + 11, &emailLen, 2);
+    out.append(header, sizeof(header));
+    out.append(token.data(), tokenLen);
+    out.append(email.data(), emailLen);
+    return true;
+}
+
+size_t SessionSnapshot::load(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno != ENOENT) LOG_ERROR("Open session snapshot %s failed: %s", path.c_str(), strerror(errno));
+        return 0;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(kMagic)) {
+        ::close(fd);
+        return 0;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        LOG_ERROR("mmap session snapshot %s failed: %s", path.c_str(), strerror(errno));
+        return 0;
+    }
+    ::madvise(map, size, MADV_SEQUENTIAL);
+
+    const char* p = static_cast<const char*>(map);
+    const char* end = p + size;
+    std::unordered_map<std::string, Session> sessions;
+    if (std::memcmp(p, kMagic, sizeof(kMagic)) != 0) {
+        LOG_ERROR("Session snapshot %s has bad magic, ignored", path.c_str());
+    } else {
+        p += sizeof(kMagic);
+        while (static_cast<size_t>(end - p) >= kRecordHeader) {
+            uint8_t type = static_cast<uint8_t>(p[0]);
+            int64_t expireAt;
+            uint16_t tokenLen, emailLen;
+            std::memcpy(&expireAt, p + 1, 8);
+            std::memcpy(&tokenLen, p + 9, 2);
+            std::memcpy(&emailLen, p + 11, 2);
+            if (static_cast<size_t>(end - p) < kRecordHeader + tokenLen + emailLen) break; // 截断的尾记录
+            std::string token(p + kRecordHeader, tokenLen);
+            if (type == kPut) {
+                Session& s = sessions[token];
+                s.email.assign(p + kRecordHeader + tokenLen, emailLen);
+                s.expireAt = fromUnixSeconds(expireAt);
+                s.token = std::move(token);
+            } else if (type == kErase) {
+                sessions.erase(token);
+            } else if (type == kTouch) {
+                auto it = sessions.find(token);
+                if (it != sessions.end()) it->second.expireAt = fromUnixSeconds(expireAt);
+            } else {
+                LOG_ERROR("Session snapshot %s has bad record type %u, stop replay", path.c_str(), type);
+                break;
+            }
+            p += kRecordHeader + tokenLen + emailLen;
+        }
+    }
+    ::munmap(map, size);
+
+    std::vector<Session> list;
+    list.reserve(sessions.size());
+    for (auto& kv : sessions) list.push_back(std::move(kv.second));
+    size_t restored = store_.restore(std::move(list));
+    LOG_INFO("Restored %zu sessions from %s", restored, path.c_str());
+    return restored;
+}
+
+bool SessionSnapshot::start(const std::string& path, std::chrono::milliseconds flushInterval,
+                            std::chrono::seconds compactInterval)
+{
+    std::lock_guard<std::mutex> lk(workerMutex_);
+    if (running_) return true;
+    path_ = path;
+    flushInterval_ = flushInterval;
+    compactInterval_ = compactInterval;
+    // 先订阅变更再压缩：压缩期间的变更留在缓冲里，之后追加到新文件
+    store_.setListener(this);
+    if (!compact()) {
+        store_.setListener(nullptr);
+        return false;
+    }
+    running_ = true;
+    worker_ = std::thread(&SessionSnapshot::run, this);
+    return true;
+}
+
+void SessionSnapshot::stop()
+{
+    {
+        std::lock_guard<std::mutex> lk(workerMutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    workerCv_.notify_all();
+    if (worker_.joinable()) worker_.join();
+    store_.setListener(nullptr);
+    if (!flushPending()) compact();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void SessionSnapshot::onPut(const Session& session)
+{
+    std::lock_guard<std::mutex> lk(pendingMutex_);
+    if (appendRecord(pending_, kPut, toUnixSeconds(session.expireAt), session.token, session.email)) ++pendingRecords_;
+}
+
+void SessionSnapshot::onErase(const std::string& token)
+{
+    std::lock_guard<std::mutex> lk(pendingMutex_);
+    if (appendRecord(pending_, kErase, 0, token, std::string())) ++pendingRecords_;
+}
+
+void SessionSnapshot::onTouch(const std::string& token, SessionStore::Clock::time_point expireAt)
+{
+    std::lock_guard<std::mutex> lk(pendingMutex_);
+    if (appendRecord(pending_, kTouch, toUnixSeconds(expireAt), token, std::string())) ++pendingRecords_;
+}
+
+bool SessionSnapshot::flushPending()
+{
+    std::string batch;
+    size_t records;
+    {
+        std::lock_guard<std::mutex> lk(pendingMutex_);
+        if (pending_.empty()) return true;
+        batch.swap(pending_);
+        records = pendingRecords_;
+        pendingRecords_ = 0;
+    }
+    // 追加失败后文件尾可能有半条记录，不能再往后追加；丢掉的批次由下一次压缩按内存中的全部会话补回
+    if (fd_ < 0 || needsCompact_) return false;
+    if (!writeAll(fd_, batch.data(), batch.size()) || ::fdatasync(fd_) != 0) {
+        LOG_ERROR("Append session snapshot %s failed: %s, compacting", path_.c_str(), strerror(errno));
+        needsCompact_ = true;
+        return false;
+    }
+    appendedRecords_ += records;
+    return true;
+}
+
+bool SessionSnapshot::compact()
+{
+    // 先把旧文件该追加的追加完，新快照只需覆盖此后的状态
+    flushPending();
+
+    std::vector<Session> sessions;
+    store_.collect(sessions);
+    std::string data(kMagic, sizeof(kMagic));
+    size_t written = 0;
+    for (const Session& s : sessions) {
+        if (appendRecord(data, kPut, toUnixSeconds(s.expireAt), s.token, s.email)) ++written;
+    }
+
+    std::string tmpPath = path_ + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        LOG_ERROR("Create session snapshot %s failed: %s", tmpPath.c_str(), strerror(errno));
+        return false;
+    }
+    if (!writeAll(fd, data.data(), data.size()) || ::fsync(fd) != 0) {
+        LOG_ERROR("Write session snapshot %s failed: %s", tmpPath.c_str(), strerror(errno));
+        ::close(fd);
+        ::unlink(tmpPath.c_str());
+        return false;
+    }
+    ::close(fd);
+    if (::rename(tmpPath.c_str(), path_.c_str()) != 0) {
+        LOG_ERROR("Rename session snapshot to %s failed: %s", path_.c_str(), strerror(errno));
+        ::unlink(tmpPath.c_str());
+        return false;
+    }
+
+    // 旧 fd 指向已被 rename 覆盖的文件，无论重新打开成功与否都不能再用
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd_ < 0) {
+        LOG_ERROR("Reopen session snapshot %s failed: %s", path_.c_str(), strerror(errno));
+        needsCompact_ = true;
+        return false;
+    }
+    needsCompact_ = false;
+    appendedRecords_ = 0;
+    liveRecords_ = written;
+    LOG_DEBUG("Session snapshot compacted: %zu sessions", written);
+    return true;
+}
+
+void SessionSnapshot::run()
+{
+    auto lastCompact = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(workerMutex_);
+    while (running_) {
+        workerCv_.wait_for(lock, flushInterval_);
+        if (!running_) break;
+        lock.unlock();
+
+        flushPending();
+        auto now = std::chrono::steady_clock::now();
+        if (needsCompact_ || appendedRecords_ > liveRecords_ + 1024 || now - lastCompact >= compactInterval_) {
+            if (compact()) lastCompact = now;
+        }
+
+        lock.lock();
+    }
+}
@@ -0,0 +1,216 @@
+#include "SessionStore.h"
+#include <algorithm>
+
+SessionStore& SessionStore::instance()
+{
+    static SessionStore inst;
+    return inst;
+}
+
+SessionStore::SessionStore(size_t shardCount, Clock::duration ttl)
+    : ttl_(ttl)
+{
+    if (shardCount == 0) {
+        shardCount = static_cast<size_t>(std::thread::hardware_concurrency()) * 4;
+        if (shardCount == 0) shardCount = 16;
+    }
+    size_t n = 1;
+    unsigned bits = 0;
+    while (n < shardCount) {
+        n <<= 1;
+        ++bits;
+    }
+    shards_.reset(new Shard[n]);
+    shardMask_ = n - 1;
+    shardShift_ = 64 - bits;
+}
+
+SessionStore::~SessionStore()
+{
+    stopSweeper();
+}
+
+SessionStore::Shard& SessionStore::shardFor(const std::string& token) const
+{
+    // 取乘法散列的高位选分片，与 unordered_map 内部按低位分桶错开
+    uint64_t h = static_cast<uint64_t>(std::hash<std::string>()(token)) * 0x9E3779B97F4A7C15ULL;
+    size_t idx = shardShift_ >= 64 ? 0 : static_cast<size_t>(h >> shardShift_);
+    return shards_[idx & shardMask_];
+}
+
+void SessionStore::unlink(Shard& shard, Entry* e)
+{
+    if (e->prev) e->prev->next = e->next; else shard.head = e->next;
+    if (e->next) e->next->prev = e->prev; else shard.tail = e->prev;
+    e->prev = e->next = nullptr;
+}
+
+void SessionStore::pushBack(Shard& shard, Entry* e)
+{
+    e->prev = shard.tail;
+    e->next = nullptr;
+    if (shard.tail) shard.tail->next = e; else shard.head = e;
+    shard.tail = e;
+}
+
+size_t SessionStore::expireLocked(Shard& shard, Clock::time_point now, size_t limit)
+{
+    size_t removed = 0;
+    while (shard.head && shard.head->session.expireAt <= now) {
+        if (limit != 0 && removed >= limit) break;
+        Entry* e = shard.head;
+        unlink(shard, e);
+        shard.sessions.erase(shard.sessions.find(*e->key));
+        ++removed;
+    }
+    return removed;
+}
+
+void SessionStore::put(const std::string& token, Session session)
+{
+    Clock::time_point now = Clock::now();
+    session.expireAt = now + ttl_;
+    Shard& shard = shardFor(token);
+    std::lock_guard<std::mutex> lk(shard.mutex);
+    // 顺带回收少量过期会话，即使没有后台线程内存也不会无限增长
+    expireLocked(shard, now, 2);
+    auto res = shard.sessions.try_emplace(token);
+    Entry& e = res.first->second;
+    if (res.second) {
+        e.key = &res.first->first;
+    } else {
+        unlink(shard, &e);
+    }
+    e.session = std::move(session);
+    e.notifiedAt = now;
+    pushBack(shard, &e);
+    if (Listener* l = listener_.load(std::memory_order_acquire)) l->onPut(e.session);
+}
+
+bool SessionStore::validate(const std::string& token, std::string* emailOut)
+{
+    Clock::time_point now = Clock::now();
+    Shard& shard = shardFor(token);
+    std::lock_guard<std::mutex> lk(shard.mutex);
+    auto it = shard.sessions.find(token);
+    if (it == shard.sessions.end()) return false;
+    Entry& e = it->second;
+    // 过期检查
+    if (now > e.session.expireAt) {
+        unlink(shard, &e);
+        shard.sessions.erase(it);
+        return false;
+    }
+    // 滑动过期：续期并移到表尾
+    e.session.expireAt = now + ttl_;
+    if (shard.tail != &e) {
+        unlink(shard, &e);
+        pushBack(shard, &e);
+    }
+    // 续期按间隔通知持久化，活跃会话重启恢复后不会按早已过时的过期时间提前失效
+    if (now - e.notifiedAt >= kTouchInterval) {
+        if (Listener* l = listener_.load(std::memory_order_acquire)) {
+            l->onTouch(token, e.session.expireAt);
+            e.notifiedAt = now;
+        }
+    }
+    if (emailOut) *emailOut = e.session.email;
+    return true;
+}
+
+bool SessionStore::erase(const std::string& token)
+{
+    Shard& shard = shardFor(token);
+    std::lock_guard<std::mutex> lk(shard.mutex);
+    auto it = shard.sessions.find(token);
+    if (it == shard.sessions.end()) return false;
+    unlink(shard, &it->second);
+    shard.sessions.erase(it);
+    if (Listener* l = listener_.load(std::memory_order_acquire)) l->onErase(token);
+    return true;
+}
+
+size_t SessionStore::sweepExpired(Clock::time_point now)
+{
+    size_t removed = 0;
+    for (size_t i = 0; i <= shardMask_; ++i) {
+        Shard& shard = shards_[i];
+        std::lock_guard<std::mutex> lk(shard.mutex);
+        removed += expireLocked(shard, now, 0);
+    }
+    return removed;
+}
+
+void SessionStore::startSweeper(Clock::duration interval)
+{
+    std::lock_guard<std::mutex> lk(sweeperMutex_);
+    if (sweeperRunning_) return;
+    sweeperRunning_ = true;
+    sweeper_ = std::thread([this, interval]() {
+        std::unique_lock<std::mutex> lock(sweeperMutex_);
+        while (sweeperRunning_) {
+            sweeperCv_.wait_for(lock, interval);
+            if (!sweeperRunning_) break;
+            lock.unlock();
+            sweepExpired();
+            lock.lock();
+        }
+    });
+}
+
+void SessionStore::stopSweeper()
+{
+    {
+        std::lock_guard<std::mutex> lk(sweeperMutex_);
+        if (!sweeperRunning_) return;
+        sweeperRunning_ = false;
+    }
+    sweeperCv_.notify_all();
+    if (sweeper_.joinable()) sweeper_.join();
+}
+
+size_t SessionStore::restore(std::vector<Session> sessions)
+{
+    Clock::time_point now = Clock::now();
+    std::sort(sessions.begin(), sessions.end(),
+              [](const Session& a, const Session& b) { return a.expireAt < b.expireAt; });
+    size_t restored = 0;
+    for (Session& session : sessions) {
+        if (session.expireAt <= now) continue;
+        Shard& shard = shardFor(session.token);
+        std::lock_guard<std::mutex> lk(shard.mutex);
+        auto res = shard.sessions.try_emplace(session.token);
+        Entry& e = res.first->second;
+        if (res.second) {
+            e.key = &res.first->first;
+            ++restored;
+        } else {
+            unlink(shard, &e);
+        }
+        e.session = std::move(session);
+        e.notifiedAt = now;
+        pushBack(shard, &e);
+    }
+    return restored;
+}
+
+void SessionStore::collect(std::vector<Session>& out) const
+{
+    Clock::time_point now = Clock::now();
+    for (size_t i = 0; i <= shardMask_; ++i) {
+        std::lock_guard<std::mutex> lk(shards_[i].mutex);
+        for (const Entry* e = shards_[i].head; e; e = e->next) {
+            if (e->session.expireAt > now) out.push_back(e->session);
+        }
+    }
+}
+
+size_t SessionStore::size() const
+{
+    size_t total = 0;
+    for (size_t i = 0; i <= shardMask_; ++i) {
+        std::lock_guard<std::mutex> lk(shards_[i].mutex);
+        total += shards_[i].sessions.size();
+    }
+    return total;
+}
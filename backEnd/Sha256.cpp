@@ -0,0 +1,219 @@
+#include "Sha256.h"
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SHA256_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+inline uint32_t rotr(uint32_t x, unsigned n) { return (x >> n) | (x << (32 - n)); }
+
+inline uint32_t loadBE32(const uint8_t* p)
+{
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+inline void storeBE32(uint8_t* p, uint32_t v)
+{
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+// 标量实现
+void compressScalar(uint32_t state[8], const uint8_t block[Sha256::kBlockSize])
+{
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) w[i] = loadBE32(block + i * 4);
+    for (int i = 16; i < 64; ++i) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; ++i) {
+        uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t t1 = h + s1 + ch + kRoundConstants[i] + w[i];
+        uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + maj;
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+#ifdef SHA256_X86
+// SHA-NI 实现：每条 sha256rnds2 完成两轮，消息扩展由 sha256msg1/msg2 完成。
+// 状态需重排为 ABEF/CDGH 两个寄存器。
+__attribute__((target("sha,sse4.1")))
+void compressShaNi(uint32_t state[8], const uint8_t block[Sha256::kBlockSize])
+{
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+    __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);            // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B);      // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8); // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);   // CDGH
+    const __m128i abefSave = state0;
+    const __m128i cdghSave = state1;
+
+    __m128i w[4];
+    for (int i = 0; i < 16; ++i) {
+        if (i < 4) {
+            w[i] = _mm_shuffle_epi8(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16)), byteSwap);
+        } else {
+            // W[i..i+3] = msg2(msg1(W[i-16..], W[i-12..]) + W[i-7..], W[i-4..])
+            __m128i x = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+            x = _mm_add_epi32(x, _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+            w[i & 3] = _mm_sha256msg2_epu32(x, w[(i + 3) & 3]);
+        }
+        __m128i msg = _mm_add_epi32(w[i & 3],
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(&kRoundConstants[i * 4])));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        msg = _mm_shuffle_epi32(msg, 0x0E);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    }
+
+    state0 = _mm_add_epi32(state0, abefSave);
+    state1 = _mm_add_epi32(state1, cdghSave);
+    tmp = _mm_shuffle_epi32(state0, 0x1B);         // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);      // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);   // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);      // HGFE
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+#endif
+
+using CompressFn = void (*)(uint32_t state[8], const uint8_t block[Sha256::kBlockSize]);
+
+CompressFn selectCompress()
+{
+#ifdef SHA256_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1")) return compressShaNi;
+#endif
+    return compressScalar;
+}
+
+const CompressFn g_compress = selectCompress();
+
+} // namespace
+
+Sha256::Sha256()
+    : state_{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19}
+{
+}
+
+void Sha256::compress(const uint8_t block[kBlockSize])
+{
+    g_compress(state_, block);
+}
+
+void Sha256::update(const void* data, size_t len)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    totalLen_ += len;
+    if (bufferLen_ != 0) {
+        size_t take = kBlockSize - bufferLen_;
+        if (take > len) take = len;
+        std::memcpy(buffer_ + bufferLen_, p, take);
+        bufferLen_ += take;
+        p += take;
+        len -= take;
+        if (bufferLen_ < kBlockSize) return;
+        compress(buffer_);
+        bufferLen_ = 0;
+    }
+    while (len >= kBlockSize) {
+        compress(p);
+        p += kBlockSize;
+        len -= kBlockSize;
+    }
+    if (len != 0) {
+        std::memcpy(buffer_, p, len);
+        bufferLen_ = len;
+    }
+}
+
+void Sha256::final(uint8_t out[kDigestSize])
+{
+    uint64_t bitLen = totalLen_ * 8;
+    buffer_[bufferLen_++] = 0x80;
+    if (bufferLen_ > kBlockSize - 8) {
+        std::memset(buffer_ + bufferLen_, 0, kBlockSize - bufferLen_);
+        compress(buffer_);
+        bufferLen_ = 0;
+    }
+    std::memset(buffer_ + bufferLen_, 0, kBlockSize - 8 - bufferLen_);
+    for (int i = 0; i < 8; ++i) {
+        buffer_[kBlockSize - 1 - i] = static_cast<uint8_t>(bitLen >> (8 * i));
+    }
+    compress(buffer_);
+    for (int i = 0; i < 8; ++i) storeBE32(out + i * 4, state_[i]);
+}
+
+void Sha256::hash(const void* data, size_t len, uint8_t out[kDigestSize])
+{
+    Sha256 ctx;
+    ctx.update(data, len);
+    ctx.final(out);
+}
+
+HmacSha256::HmacSha256(std::string_view key)
+{
+    uint8_t block[Sha256::kBlockSize] = {};
+    if (key.size() > Sha256::kBlockSize) {
+        Sha256::hash(key.data(), key.size(), block);
+    } else {
+        std::memcpy(block, key.data(), key.size());
+    }
+
+    uint8_t pad[Sha256::kBlockSize];
+    for (size_t i = 0; i < Sha256::kBlockSize; ++i) pad[i] = block[i] ^ 0x36;
+    inner_.update(pad, sizeof(pad));
+    for (size_t i = 0; i < Sha256::kBlockSize; ++i) pad[i] = block[i] ^ 0x5c;
+    outer_.update(pad, sizeof(pad));
+}
+
+void HmacSha256::compute(const void* data, size_t len, uint8_t out[Sha256::kDigestSize]) const
+{
+    uint8_t innerDigest[Sha256::kDigestSize];
+    Sha256 inner = inner_;
+    inner.update(data, len);
+    inner.final(innerDigest);
+
+    Sha256 outer = outer_;
+    outer.update(innerDigest, sizeof(innerDigest));
+    outer.final(out);
+}
+
+bool constantTimeEqual(const uint8_t* a, const uint8_t* b, size_t len)
+{
+    uint8_t diff = 0;
+    for (size_t i = 0; i < len; ++i) diff |= static_cast<uint8_t>(a[i] ^ b[i]);
+    return diff == 0;
+}
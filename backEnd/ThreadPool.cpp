@@ -0,0 +1,101 @@
+#include "ThreadPool.h"
+#include "LogM.h"
+
+ThreadPool::ThreadPool(size_t threadCount, size_t maxPending)
+    : maxPending_(maxPending)
+{
+    if (threadCount == 0) threadCount = 1;
+    workers_.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    shutdown();
+}
+
+bool ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!isRunning_ || (maxPending_ != 0 && tasks_.size() >= maxPending_)) {
+            ++stats_.rejected;
+            return false;
+        }
+        tasks_.push_back(Task{std::move(task), SteadyClock::now()});
+        ++stats_.submitted;
+        if (tasks_.size() > stats_.peakPending) stats_.peakPending = tasks_.size();
+    }
+    condVar_.notify_one();
+    return true;
+}
+
+size_t ThreadPool::pending()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size();
+}
+
+ThreadPoolStats ThreadPool::stats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ThreadPoolStats s = stats_;
+    s.threads = workers_.size();
+    s.pending = tasks_.size();
+    s.completed = completed_.load(std::memory_order_relaxed);
+    s.avgRunUs = avgRunUs_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void ThreadPool::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!isRunning_) return;
+        isRunning_ = false;
+    }
+    condVar_.notify_all();
+    for (auto& t : workers_) {
+        if (t.joinable()) t.join();
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true) {
+        std::function<void()> task;
+        SteadyClock::time_point startedAt;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condVar_.wait(lock, [this]() {
+                return !tasks_.empty() || !isRunning_;
+            });
+            // 关闭后仍把队列里的任务执行完
+            if (tasks_.empty()) return;
+            Task& front = tasks_.front();
+            startedAt = SteadyClock::now();
+            uint64_t waitUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                startedAt - front.enqueuedAt).count());
+            task = std::move(front.fn);
+            tasks_.pop_front();
+            stats_.totalWaitUs += waitUs;
+            if (waitUs > stats_.maxWaitUs) stats_.maxWaitUs = waitUs;
+        }
+        try {
+            task();
+        } catch (const std::exception& e) {
+            LOG_ERROR("Unhandled exception in worker task: %s", e.what());
+        } catch (...) {
+            LOG_ERROR("Unhandled unknown exception in worker task");
+        }
+        completed_.fetch_add(1, std::memory_order_relaxed);
+        // 多线程并发更新时可能丢失个别样本，作为估算值可以接受
+        int64_t runUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            SteadyClock::now() - startedAt).count();
+        int64_t avg = static_cast<int64_t>(avgRunUs_.load(std::memory_order_relaxed));
+        avg = avg == 0 ? runUs : avg + (runUs - avg) / 8;
+        avgRunUs_.store(static_cast<uint64_t>(avg), std::memory_order_relaxed);
+    }
+}
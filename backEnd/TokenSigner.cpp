@@ -0,0 +1,234 @@
+#include "TokenSigner.h"
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <stdexcept>
+
+std::unique_ptr<TokenSigner> TokenSigner::instance_;
+
+namespace {
+
+const char kB64Url[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// base64url 反查表，非法字符为 0xff
+struct B64UrlDecodeTable {
+    uint8_t v[256];
+    constexpr B64UrlDecodeTable() : v()
+    {
+        for (int i = 0; i < 256; ++i) v[i] = 0xff;
+        for (int i = 0; i < 64; ++i) v[static_cast<uint8_t>(kB64Url[i])] = static_cast<uint8_t>(i);
+    }
+};
+constexpr B64UrlDecodeTable kB64UrlDecode;
+
+void base64UrlEncode(const uint8_t* in, size_t len, std::string& out)
+{
+    size_t i = 0;
+    for (; i + 3 <= len; i += 3) {
+        uint32_t v = (uint32_t(in[i]) << 16) | (uint32_t(in[i + 1]) << 8) | in[i + 2];
+        out.push_back(kB64Url[(v >> 18) & 63]);
+        out.push_back(kB64Url[(v >> 12) & 63]);
+        out.push_back(kB64Url[(v >> 6) & 63]);
+        out.push_back(kB64Url[v & 63]);
+    }
+    if (len - i == 1) {
+        uint32_t v = uint32_t(in[i]) << 16;
+        out.push_back(kB64Url[(v >> 18) & 63]);
+        out.push_back(kB64Url[(v >> 12) & 63]);
+    } else if (len - i == 2) {
+        uint32_t v = (uint32_t(in[i]) << 16) | (uint32_t(in[i + 1]) << 8);
+        out.push_back(kB64Url[(v >> 18) & 63]);
+        out.push_back(kB64Url[(v >> 12) & 63]);
+        out.push_back(kB64Url[(v >> 6) & 63]);
+    }
+}
+
+// 无填充解码；输入非法或输出超过 cap 时返回 0
+size_t base64UrlDecode(std::string_view in, uint8_t* out, size_t cap)
+{
+    if (in.size() % 4 == 1) return 0;
+    size_t outLen = in.size() / 4 * 3 + (in.size() % 4 ? in.size() % 4 - 1 : 0);
+    if (outLen > cap) return 0;
+
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(in.data());
+    size_t n = in.size();
+    size_t o = 0;
+    uint8_t bad = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        uint8_t a = kB64UrlDecode.v[p[i]], b = kB64UrlDecode.v[p[i + 1]];
+        uint8_t c = kB64UrlDecode.v[p[i + 2]], d = kB64UrlDecode.v[p[i + 3]];
+        bad |= a | b | c | d;
+        uint32_t v = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6) | d;
+        out[o++] = static_cast<uint8_t>(v >> 16);
+        out[o++] = static_cast<uint8_t>(v >> 8);
+        out[o++] = static_cast<uint8_t>(v);
+    }
+    if (n - i >= 2) {
+        uint8_t a = kB64UrlDecode.v[p[i]], b = kB64UrlDecode.v[p[i + 1]];
+        uint8_t c = n - i == 3 ? kB64UrlDecode.v[p[i + 2]] : 0;
+        bad |= a | b | c;
+        uint32_t v = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6);
+        out[o++] = static_cast<uint8_t>(v >> 16);
+        if (n - i == 3) out[o++] = static_cast<uint8_t>(v >> 8);
+    }
+    // 合法字符都小于 64，任一非法字符都会使最高位置 1
+    return (bad & 0x80) ? 0 : o;
+}
+
+inline uint32_t nowSeconds()
+{
+    return static_cast<uint32_t>(std::time(nullptr));
+}
+
+inline size_t slotIndex(uint64_t nonce)
+{
+    return static_cast<size_t>((nonce * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+} // namespace
+
+void TokenSigner::init(std::string_view secret, std::chrono::seconds ttl, size_t revocationCapacity)
+{
+    if (instance_) return;
+    if (secret.empty()) throw std::invalid_argument("token secret must not be empty");
+    instance_.reset(new TokenSigner(secret, ttl, revocationCapacity));
+}
+
+TokenSigner::TokenSigner(std::string_view secret, std::chrono::seconds ttl, size_t revocationCapacity)
+    : hmac_(secret), ttl_(ttl)
+{
+    size_t n = kMaxProbe;
+    while (n < revocationCapacity) n <<= 1;
+    revokedTables_.push_back(std::make_unique<RevokedTable>(n));
+    revoked_.store(revokedTables_.back().get(), std::memory_order_release);
+}
+
+std::string TokenSigner::issue(std::string_view email) const
+{
+    if (email.size() > kMaxEmailBytes) throw std::invalid_argument("email too long for signed token");
+
+    thread_local std::mt19937_64 rng(std::random_device{}());
+    uint64_t nonce = 0;
+    while (nonce == 0) nonce = rng(); // 0 保留给撤销表的空槽
+    uint32_t expireAt = nowSeconds() + static_cast<uint32_t>(ttl_.count());
+
+    uint8_t buf[kMaxTokenBytes];
+    for (int i = 0; i < 4; ++i) buf[i] = static_cast<uint8_t>(expireAt >> (24 - 8 * i));
+    for (int i = 0; i < 8; ++i) buf[4 + i] = static_cast<uint8_t>(nonce >> (56 - 8 * i));
+    std::memcpy(buf + kHeaderBytes, email.data(), email.size());
+    size_t payloadLen = kHeaderBytes + email.size();
+    hmac_.compute(buf, payloadLen, buf + payloadLen);
+
+    std::string token(kPrefix);
+    token.reserve(kPrefix.size() + (payloadLen + Sha256::kDigestSize) * 4 / 3 + 3);
+    base64UrlEncode(buf, payloadLen + Sha256::kDigestSize, token);
+    return token;
+}
+
+bool TokenSigner::decode(std::string_view token, uint8_t* buf, Claims& claims) const
+{
+    if (!looksSigned(token)) return false;
+    size_t len = base64UrlDecode(token.substr(kPrefix.size()), buf, kMaxTokenBytes);
+    if (len < kHeaderBytes + Sha256::kDigestSize) return false;
+
+    size_t payloadLen = len - Sha256::kDigestSize;
+    uint8_t mac[Sha256::kDigestSize];
+    hmac_.compute(buf, payloadLen, mac);
+    if (!constantTimeEqual(mac, buf + payloadLen, Sha256::kDigestSize)) return false;
+
+    claims.expireAt = 0;
+    for (int i = 0; i < 4; ++i) claims.expireAt = (claims.expireAt << 8) | buf[i];
+    claims.nonce = 0;
+    for (int i = 0; i < 8; ++i) claims.nonce = (claims.nonce << 8) | buf[4 + i];
+    claims.email = std::string_view(reinterpret_cast<const char*>(buf + kHeaderBytes), payloadLen - kHeaderBytes);
+    return nowSeconds() < claims.expireAt;
+}
+
+bool TokenSigner::isRevoked(uint64_t nonce) const
+{
+    const RevokedTable& table = *revoked_.load(std::memory_order_acquire);
+    size_t idx = slotIndex(nonce);
+    for (size_t i = 0; i < kMaxProbe; ++i) {
+        uint64_t v = table.slots[(idx + i) & table.mask].nonce.load(std::memory_order_acquire);
+        if (v == nonce) return true;
+        if (v == 0) return false;
+    }
+    return false;
+}
+
+bool TokenSigner::verify(std::string_view token, std::string* emailOut) const
+{
+    uint8_t buf[kMaxTokenBytes];
+    Claims claims;
+    if (!decode(token, buf, claims)) return false;
+    if (isRevoked(claims.nonce)) return false;
+    if (emailOut) emailOut->assign(claims.email.data(), claims.email.size());
+    return true;
+}
+
+bool TokenSigner::revoke(std::string_view token)
+{
+    Revocation r;
+    return revocationOf(token, r) && applyRevocation(r);
+}
+
+bool TokenSigner::revocationOf(std::string_view token, Revocation& out) const
+{
+    uint8_t buf[kMaxTokenBytes];
+    Claims claims;
+    if (!decode(token, buf, claims) || isRevoked(claims.nonce)) return false;
+    out.nonce = claims.nonce;
+    out.expireAt = claims.expireAt;
+    return true;
+}
+
+bool TokenSigner::applyRevocation(const Revocation& r)
+{
+    uint32_t now = nowSeconds();
+    if (r.nonce == 0 || r.expireAt <= now) return false;
+    std::lock_guard<std::mutex> lk(revokeMutex_);
+    if (isRevoked(r.nonce)) return false;
+    while (!insertLocked(*revoked_.load(std::memory_order_relaxed), r.nonce, r.expireAt, now)) {
+        growLocked(now);
+    }
+    return true;
+}
+
+bool TokenSigner::insertLocked(RevokedTable& table, uint64_t nonce, uint32_t expireAt, uint32_t now)
+{
+    size_t idx = slotIndex(nonce);
+    for (size_t i = 0; i < kMaxProbe; ++i) {
+        RevokedSlot& slot = table.slots[(idx + i) & table.mask];
+        uint64_t v = slot.nonce.load(std::memory_order_relaxed);
+        // 空槽或对应 token 已过期的槽位可以复用
+        if (v == 0 || slot.expireAt <= now) {
+            slot.expireAt = expireAt;
+            slot.nonce.store(nonce, std::memory_order_release);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TokenSigner::growLocked(uint32_t now)
+{
+    const RevokedTable& old = *revoked_.load(std::memory_order_relaxed);
+    size_t capacity = (old.mask + 1) * 2;
+    while (true) {
+        auto table = std::make_unique<RevokedTable>(capacity);
+        bool placed = true;
+        for (size_t i = 0; i <= old.mask && placed; ++i) {
+            const RevokedSlot& slot = old.slots[i];
+            uint64_t v = slot.nonce.load(std::memory_order_relaxed);
+            if (v != 0 && slot.expireAt > now) placed = insertLocked(*table, v, slot.expireAt, now);
+        }
+        if (placed) {
+            revokedTables_.push_back(std::move(table));
+            revoked_.store(revokedTables_.back().get(), std::memory_order_release);
+            return;
+        }
+        // 哈希分布极不均匀时，继续加倍直到全部放得下
+        capacity *= 2;
+    }
+}
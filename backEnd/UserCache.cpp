@@ -0,0 +1,99 @@
+#include "UserCache.h"
+
+namespace {
+size_t g_initCapacity = 10000;
+std::chrono::seconds g_initTtl(300);
+}
+
+void UserCache::init(size_t capacity, std::chrono::seconds ttl)
+{
+    g_initCapacity = capacity;
+    g_initTtl = ttl;
+}
+
+UserCache& UserCache::instance()
+{
+    static UserCache inst(g_initCapacity, g_initTtl);
+    return inst;
+}
+
+UserCache::UserCache(size_t capacity, Clock::duration ttl, size_t shardCount)
+    : shards_(new Shard[shardCount == 0 ? 1 : shardCount]),
+      shardCount_(shardCount == 0 ? 1 : shardCount),
+      ttl_(ttl)
+{
+    shardCapacity_ = (capacity + shardCount_ - 1) / shardCount_;
+    if (shardCapacity_ == 0) shardCapacity_ = 1;
+}
+
+UserCache::Shard& UserCache::shardFor(const std::string& email)
+{
+    return shards_[std::hash<std::string>()(email) % shardCount_];
+}
+
+bool UserCache::get(const std::string& email, UserInfo& out)
+{
+    Shard& shard = shardFor(email);
+    std::lock_guard<std::mutex> lk(shard.mutex);
+    auto it = shard.index.find(email);
+    if (it == shard.index.end()) {
+        ++shard.misses;
+        return false;
+    }
+    if (Clock::now() >= it->second->expireAt) {
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+        ++shard.misses;
+        return false;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    out = it->second->info;
+    ++shard.hits;
+    return true;
+}
+
+void UserCache::put(const UserInfo& info)
+{
+    if (info.email.empty()) return;
+    Shard& shard = shardFor(info.email);
+    std::lock_guard<std::mutex> lk(shard.mutex);
+    Clock::time_point expireAt = Clock::now() + ttl_;
+    auto it = shard.index.find(info.email);
+    if (it != shard.index.end()) {
+        it->second->info = info;
+        it->second->expireAt = expireAt;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return;
+    }
+    if (shard.index.size() >= shardCapacity_) {
+        shard.index.erase(shard.lru.back().info.email);
+        shard.lru.pop_back();
+        ++shard.evictions;
+    }
+    shard.lru.push_front(Node{info, expireAt});
+    shard.index.emplace(info.email, shard.lru.begin());
+}
+
+void UserCache::invalidate(const std::string& email)
+{
+    Shard& shard = shardFor(email);
+    std::lock_guard<std::mutex> lk(shard.mutex);
+    auto it = shard.index.find(email);
+    if (it == shard.index.end()) return;
+    shard.lru.erase(it->second);
+    shard.index.erase(it);
+}
+
+UserCacheStats UserCache::stats() const
+{
+    UserCacheStats s;
+    s.capacity = shardCapacity_ * shardCount_;
+    for (size_t i = 0; i < shardCount_; ++i) {
+        std::lock_guard<std::mutex> lk(shards_[i].mutex);
+        s.hits += shards_[i].hits;
+        s.misses += shards_[i].misses;
+        s.evictions += shards_[i].evictions;
+        s.size += shards_[i].index.size();
+    }
+    return s;
+}
@@ -0,0 +1,144 @@
+#ifndef ACCESSLOG_H
+#define ACCESSLOG_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 单个请求在各线程上累计的分段耗时。由连接层持有，请求期间通过线程局部指针交给处理函数；
+// 密码哈希等异步任务需在投递时取 current()，在任务线程里用 Scope 重新挂上，并在回写响应前结束计时。
+struct RequestTrace {
+    std::atomic<uint32_t> dbUs{0};
+    std::atomic<uint32_t> bcryptUs{0};
+    int32_t routeId = -1; // 工作线程写入，事件循环在处理函数返回后读取
+
+    void reset()
+    {
+        dbUs.store(0, std::memory_order_relaxed);
+        bcryptUs.store(0, std::memory_order_relaxed);
+        routeId = -1;
+    }
+
+    // 当前线程正在处理的请求；访问日志未开启时为 nullptr
+    static RequestTrace* current();
+
+    class Scope {
+    public:
+        explicit Scope(RequestTrace* trace);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        RequestTrace* prev_;
+    };
+};
+
+enum class TracePhase { Db, Bcrypt };
+
+// 把作用域内的耗时累加到当前请求的对应分段；当前线程没有挂请求时不读时钟
+class PhaseTimer {
+public:
+    explicit PhaseTimer(TracePhase phase)
+        : trace_(RequestTrace::current()), phase_(phase)
+    {
+        if (trace_) start_ = std::chrono::steady_clock::now();
+    }
+    ~PhaseTimer();
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    RequestTrace* trace_;
+    TracePhase phase_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// 每个请求一条的定长访问记录（事件循环在响应写完后填写）
+struct AccessRecord {
+    int64_t startNs;      // 开始解析该请求的时刻（steady_clock），写出时换算为 Unix 微秒
+    uint32_t clientIp;    // IPv4，网络字节序
+    uint16_t status;
+    uint8_t method;       // HttpMethod
+    uint8_t reserved;
+    int32_t routeId;      // 路由表下标，未匹配为 -1
+    uint32_t connRequest; // 该请求是所在连接上的第几条（>1 即复用了长连接）
+    uint32_t bytesIn;     // 请求报文字节数
+    uint32_t bytesOut;    // 响应报文字节数
+    uint32_t parseUs;
+    uint32_t handlerUs;   // 工作线程中处理函数的耗时（异步的哈希部分不计入）
+    uint32_t dbUs;
+    uint32_t bcryptUs;
+    uint32_t totalUs;     // 开始解析到响应写完
+};
+
+struct AccessLogStats {
+    uint64_t written = 0; // 已写入文件的记录数
+    uint64_t dropped = 0; // 线程缓冲区写满而丢弃的记录数
+};
+
+// 访问日志：每个请求一行 NDJSON（字段见 README），与 LogM 的运行日志分开。
+// 调用线程只把定长记录拷进本线程的无锁环形缓冲区（满则丢弃并计数，不阻塞请求路径）；
+// 后台线程按周期或在缓冲区过半时统一编码，攒成大块顺序写入文件。
+class AccessLog {
+public:
+    static AccessLog& instance();
+
+    // 打开 path（追加模式，自动建目录）并启动后台线程；ringRecords 为每线程缓冲的记录数
+    bool start(const std::string& path,
+               std::chrono::milliseconds flushInterval = std::chrono::milliseconds(200),
+               size_t ringRecords = 8192);
+    // 停止后台线程，写出缓冲中剩余的记录
+    void stop();
+
+    bool enabled() const { return running_.load(std::memory_order_relaxed); }
+    // 任意线程调用；未启动时直接返回
+    void append(const AccessRecord& record);
+
+    AccessLogStats stats() const;
+
+    AccessLog(const AccessLog&) = delete;
+    AccessLog& operator=(const AccessLog&) = delete;
+
+private:
+    struct Ring;
+    struct RingHandle;
+
+    AccessLog();
+    ~AccessLog();
+    static void stopAtExit();
+
+    Ring* localRing();
+    void run();
+    // 取出各线程缓冲区中的记录并写出（已停止时计入丢弃），调用方持有 drainMutex_
+    void drain();
+    void writeOut(const char* data, size_t len, size_t lines);
+
+    int fd_{-1};
+    size_t ringRecords_{8192};
+    int64_t wallOffsetNs_{0}; // system_clock - steady_clock，用于换算记录时间
+    std::unique_ptr<char[]> out_; // 编码缓冲，持有 drainMutex_ 时使用
+    std::mutex drainMutex_;       // 排空只能有一个消费者：后台线程、stop 与停止后补排空的 append 互斥
+
+    std::mutex ringsMutex_;
+    std::vector<std::unique_ptr<Ring>> rings_;
+
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::thread worker_;
+    std::mutex workerMutex_;
+    std::condition_variable workerCv_;
+    std::atomic<bool> wakePending_{false};
+    std::atomic<bool> running_{false};
+    std::chrono::milliseconds flushInterval_{200};
+};
+
+#endif // ACCESSLOG_H
@@ -0,0 +1,96 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// 指针递增式内存池：每个连接一个，请求处理完后整体 reset。
+// 单个 Arena 同一时刻只能被一个线程分配（连接上同时只有一个在途请求）。
+class Arena {
+public:
+    explicit Arena(size_t chunkSize = 16 * 1024);
+    ~Arena();
+
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t));
+
+    // 回收全部分配；上一轮若用到多个块，合并成一个足够大的块保留下来，
+    // 稳态下每个请求都不再向系统申请内存
+    void reset();
+
+    size_t used() const { return used_; }
+
+    // 当前线程正在使用的 Arena（由 ArenaScope 设置），没有则为 nullptr
+    static Arena* current();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+private:
+    struct Chunk {
+        Chunk* next;
+        size_t size;
+    };
+
+    void addChunk(size_t minBytes);
+    void freeChunks();
+
+    Chunk* head_{nullptr};
+    char* cur_{nullptr};
+    char* end_{nullptr};
+    size_t chunkSize_;
+    size_t used_{0};
+    size_t capacity_{0};
+
+};
+
+// 在作用域内把 arena 设为当前线程的默认分配来源
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena);
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena* prev_;
+};
+
+// 标准分配器适配：默认构造时绑定当前线程的 Arena，没有时退回堆分配。
+// Arena 内的释放是空操作，内存在 reset 时统一回收。
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept : arena_(Arena::current()) {}
+    explicit ArenaAllocator(Arena* arena) noexcept : arena_(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.arena()) {}
+
+    T* allocate(size_t n)
+    {
+        if (arena_) return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        if (!arena_) std::allocator<T>().deallocate(p, n);
+    }
+
+    Arena* arena() const { return arena_; }
+
+    friend bool operator==(const ArenaAllocator& a, const ArenaAllocator& b) { return a.arena_ == b.arena_; }
+    friend bool operator!=(const ArenaAllocator& a, const ArenaAllocator& b) { return a.arena_ != b.arena_; }
+
+private:
+    Arena* arena_;
+};
+
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+#endif // ARENA_H
@@ -2,36 +2,35 @@
 #define CONNECTPROC_H
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <functional>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <thread>
 #include <iostream>
+#include "HttpParser.h"
+#include "Responder.h"
 
-struct HttpRequest {
-    std::string method;
-    std::string path;
-    std::string version;
-    std::unordered_map<std::string, std::string> headers;
-    std::string body;
-    std::string token;
+// 服务端运行参数
+struct ServerOptions {
+    int workerThreads = 0;     // 业务线程数，<=0 时取 CPU 核数
+    int maxConnections = 1024; // 同时保持的客户端连接上限，超出的新连接直接关闭
+    int idleTimeoutMs = 60000; // 长连接空闲超时，超时后由服务端关闭
+    int maxRequestsPerConnection = 1000; // 单个长连接最多处理的请求数，达到后回复 Connection: close
+    size_t maxHeaderBytes = 16 * 1024;   // 请求行 + 头部上限，超出回 431
+    size_t maxBodyBytes = 1024 * 1024;   // 正文上限，超出回 413
+    std::string metricsToken;  // /api/metrics 的访问令牌（Authorization: Bearer），为空时该接口一律 404
 };
 
-static inline std::string trim(const std::string& s) {
-    size_t start = s.find_first_not_of(" \t\r\n");
-    if (start == std::string::npos) return "";
-    size_t end = s.find_last_not_of(" \t\r\n");
-    return s.substr(start, end - start + 1);
-}
+// 按 HTTP 版本与 Connection 头判断客户端是否希望保持连接
+bool wants_keep_alive(const HttpRequest& req);
 
-// 解析原始HTTP请求报文，填充HttpRequest结构体。目前假设可以一次性读完
-bool parse_http_request(const std::string& raw, HttpRequest& req);
+// 处理一条已解析的请求（在工作线程中执行）：按路由表分发，结果通过 respond 回写
+void handle_request(const HttpRequest& req, const Responder& respond);
+// 启动监听端口（epoll 事件循环 + 固定大小工作线程池），返回0成功，非0错误
+int ProcWebConnect(int port, const ServerOptions& options = ServerOptions());
 
-// 处理单个客户端
-void handle_client(int client_fd);
-// 启动监听端口，返回0成功，非0错误
-int ProcWebConnect(int port);
-
-#endif // CONNECTPROC_H
\ No newline at end of file
+#endif // CONNECTPROC_H
@@ -0,0 +1,97 @@
+#ifndef EMAILFILTER_H
+#define EMAILFILTER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+// 布隆过滤器：位数组由原子 64 位字组成，add/mightContain 均无锁，可多线程并发调用。
+// k 个位置由一次 64 位哈希经双重散列（h1 + i*h2）得到。
+class BloomFilter {
+public:
+    // expected 为预计元素个数，bitsPerItem 约 10 时误判率约 1%
+    BloomFilter(size_t expected, size_t bitsPerItem = 10);
+
+    void add(std::string_view key);
+    bool mightContain(std::string_view key) const;
+
+    size_t bitCount() const { return bitMask_ + 1; }
+    unsigned hashCount() const { return hashCount_; }
+
+private:
+    static uint64_t hash64(std::string_view key);
+
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+    uint64_t bitMask_;
+    unsigned hashCount_;
+};
+
+struct EmailFilterStats {
+    bool ready = false;
+    size_t capacity = 0;
+    uint64_t inserted = 0;
+    uint64_t rejected = 0; // 判定为"一定不存在"而未查库的次数
+    uint64_t rescans = 0;  // 后台增量扫描成功的次数
+};
+
+// 已注册邮箱的负缓存：启动时扫描 sys_user 建立，注册成功时追加，
+// 后台线程按周期从上次看到的主键之后增量扫描，补上其他进程或直接写库新增的用户。
+// 登录时若判定邮箱一定不存在，直接返回"邮箱或密码错误"，不借连接、不查该邮箱。
+// 邮箱按 ASCII 小写归一化（sys_user 使用大小写不敏感的排序规则）。
+//
+// 请求路径只读过滤器，从不等待扫描：别处新增的用户最多晚一个扫描周期（默认 1s）被认出，
+// 本进程注册的用户则立即加入。
+class EmailFilter {
+public:
+    static EmailFilter& instance();
+
+    // 扫描 sys_user 建立过滤器，成功后 ready() 为 true；失败时过滤器保持关闭，所有查询放行
+    bool build();
+    // 启动后台增量扫描线程（需先 build 成功）；重复调用无效
+    void startRefresher(std::chrono::milliseconds interval = std::chrono::seconds(1));
+    void stopRefresher();
+    void add(std::string_view email);
+    // 未就绪时总是返回 true
+    bool mightExist(std::string_view email);
+
+    bool ready() const { return filter_.load(std::memory_order_acquire) != nullptr; }
+    EmailFilterStats stats() const;
+
+    EmailFilter(const EmailFilter&) = delete;
+    EmailFilter& operator=(const EmailFilter&) = delete;
+
+private:
+    EmailFilter() = default;
+    ~EmailFilter();
+
+    // count 为 false 时只置位、不计入 inserted（增量扫描重读到的行）
+    void addNormalized(BloomFilter& filter, std::string_view email, bool count);
+    // 增量扫描 id > scanFrom_ 的邮箱并加入过滤器，仅由后台线程调用，借连接用短期限。
+    // 成功后把起点推进到上一次扫描看到的最大 id：自增 id 的提交顺序不一定与分配顺序一致，
+    // 起点落后一个周期，稍晚提交的较小 id 下个周期仍会被扫到
+    bool rescan();
+
+    std::unique_ptr<BloomFilter> owned_;
+    std::atomic<BloomFilter*> filter_{nullptr};
+    size_t capacity_{0};
+    std::atomic<uint64_t> inserted_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> rescans_{0};
+
+    // 由 build 设置，之后只由后台线程读写
+    uint64_t scanFrom_{0};
+    uint64_t maxSeenId_{0};
+
+    std::thread refresher_;
+    std::mutex refresherMutex_;
+    std::condition_variable refresherCv_;
+    bool refresherRunning_{false};
+};
+
+#endif // EMAILFILTER_H
@@ -0,0 +1,48 @@
+#ifndef HASHPOOL_H
+#define HASHPOOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "ThreadPool.h"
+
+// 密码哈希专用线程池：bcrypt（cost 12）单次需几十到上百毫秒，
+// 放在独立、有界的线程池里执行，避免占满请求工作线程，登出等轻量请求不受登录排队影响。
+// 任务在哈希线程上执行，结束时通过调用方捕获的 Responder 回写到连接层。
+class HashPool {
+public:
+    // 获取单例实例
+    static HashPool& instance();
+    // 初始化：threads<=0 时取 CPU 核数的一半（至少 1）；maxPending 为排队上限；
+    // maxWaitMs 为准入预算：估算的排队+计算时间超过它的新请求直接拒绝
+    static void init(int threads, size_t maxPending, int maxWaitMs = 2000);
+
+    // 准入检查（在查库、解析之前调用）：按当前队列深度与单次哈希耗时估算新任务的完成时间，
+    // 超出预算或队列已满时返回 false，并通过 retryAfterSec 给出建议的 Retry-After 秒数
+    bool admit(int* retryAfterSec);
+
+    // 投递哈希任务；未初始化、已关闭或队列已满时返回 false，调用方应直接回复 503
+    bool submit(std::function<void()> task);
+
+    // 按统计值估算新任务从入队到完成所需时间（微秒）
+    static uint64_t estimatedWaitUs(const ThreadPoolStats& s);
+
+    ThreadPoolStats stats();
+    uint64_t shedCount() const { return shed_.load(std::memory_order_relaxed); }
+    void shutdown();
+
+    HashPool(const HashPool&) = delete;
+    HashPool& operator=(const HashPool&) = delete;
+
+private:
+    HashPool() = default;
+
+    std::unique_ptr<ThreadPool> pool_;
+    size_t maxPending_{0};
+    uint64_t maxWaitUs_{0};
+    std::atomic<uint64_t> shed_{0}; // 被准入控制拒绝的请求数
+};
+
+#endif // HASHPOOL_H
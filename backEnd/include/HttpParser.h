@@ -0,0 +1,128 @@
+#ifndef HTTPPARSER_H
+#define HTTPPARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// 常用头部的预定义编号，解析时识别一次，之后按编号 O(1) 查找
+enum class HeaderId : uint8_t {
+    Other = 0,
+    ContentLength,
+    ContentType,
+    Authorization,
+    Token,
+    Connection,
+    TransferEncoding,
+    Count
+};
+
+// 按名称（忽略大小写）识别常用头部，不做哈希
+HeaderId headerIdOf(std::string_view name);
+
+// ASCII 忽略大小写比较
+bool equalsIgnoreCase(std::string_view a, std::string_view b);
+
+struct HttpHeader {
+    std::string_view name;
+    std::string_view value;
+    HeaderId id;
+};
+
+// 定长内联头部表：不分配内存；常用头部按编号直接定位，其余按名称线性查找
+class HttpHeaders {
+public:
+    static const size_t kMaxHeaders = 64;
+
+    // 表满时返回 false；同名常用头部以第一次出现的为准
+    bool add(std::string_view name, std::string_view value, HeaderId id)
+    {
+        if (count_ >= kMaxHeaders) return false;
+        HttpHeader& h = items_[count_++];
+        h.name = name;
+        h.value = value;
+        h.id = id;
+        size_t k = static_cast<size_t>(id);
+        if (id != HeaderId::Other && known_[k] == 0) {
+            known_[k] = static_cast<uint8_t>(count_);
+        }
+        return true;
+    }
+
+    std::string_view get(HeaderId id) const;
+    std::string_view get(std::string_view name) const; // 忽略大小写
+    bool has(HeaderId id) const { return known_[static_cast<size_t>(id)] != 0; }
+
+    size_t size() const { return count_; }
+    const HttpHeader* begin() const { return items_; }
+    const HttpHeader* end() const { return items_ + count_; }
+
+    void clear();
+    // 底层缓冲区搬移后，整体平移所有视图
+    void rebase(const char* oldBase, const char* newBase);
+
+private:
+    HttpHeader items_[kMaxHeaders];
+    size_t count_{0};
+    uint8_t known_[static_cast<size_t>(HeaderId::Count)]{}; // 下标 + 1，0 表示不存在
+};
+
+// 解析结果：所有字段都是指向连接读缓冲区的视图，不拷贝数据。
+// 视图只在该请求处理完成、缓冲区被移动/清理之前有效。
+struct HttpRequest {
+    std::string_view method;
+    std::string_view path;
+    std::string_view version;
+    HttpHeaders headers;
+    std::string_view body;
+    std::string_view token;
+
+    void clear();
+};
+
+// 可恢复的 HTTP/1.x 请求解析状态机：数据可分多次到达，
+// 每次以缓冲区起点（即请求起点）和当前长度调用 parse，已扫描过的部分不会重复扫描。
+// 请求行与头部在扫描时直接写入 HttpRequest；若两次调用之间缓冲区被搬移，先平移已有视图。
+class HttpParser {
+public:
+    enum class Result {
+        Complete,   // 已得到完整请求，consumed() 为其字节数
+        Incomplete, // 需要更多数据
+        Error       // 请求非法，errorStatus() 为应答状态码
+    };
+
+    explicit HttpParser(size_t maxHeaderBytes = 16 * 1024,
+                        size_t maxBodyBytes = 1024 * 1024);
+
+    Result parse(const char* data, size_t len, HttpRequest& req);
+
+    // 开始解析下一条请求
+    void reset();
+
+    size_t consumed() const { return consumed_; }
+    int errorStatus() const { return errorStatus_; }
+
+private:
+    enum class State { RequestLine, Headers, Body, Done };
+    static const size_t kNoColon = static_cast<size_t>(-1);
+
+    Result fail(int status);
+    bool parseRequestLine(const char* data, size_t lineEnd, HttpRequest& req);
+    bool parseHeaderLine(const char* data, size_t lineEnd, HttpRequest& req);
+    void extractToken(HttpRequest& req) const;
+
+    size_t maxHeaderBytes_;
+    size_t maxBodyBytes_;
+
+    State state_{State::RequestLine};
+    const char* base_{nullptr}; // 上次调用时的缓冲区起点
+    size_t lineStart_{0};   // 当前行起点
+    size_t scanPos_{0};     // 下次从这里继续扫描
+    size_t colonPos_{kNoColon}; // 当前头部行中冒号的位置
+    size_t bodyStart_{0};
+    size_t contentLength_{0};
+    size_t consumed_{0};
+    int errorStatus_{0};
+};
+
+#endif // HTTPPARSER_H
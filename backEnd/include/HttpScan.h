@@ -0,0 +1,18 @@
+#ifndef HTTPSCAN_H
+#define HTTPSCAN_H
+
+#include <cstddef>
+
+// HTTP 头部分隔符扫描。启动时按 CPU 能力选择 AVX2 / SSE4.2 / 标量实现，
+// 一次比较 32 / 16 字节，用于定位 ':'、'\r'、'\n' 等分隔符。
+
+// 返回 [p, end) 中第一个等于 a 或 b 的字符位置，找不到返回 end
+const char* scanChar2(const char* p, const char* end, char a, char b);
+
+// 返回 [p, end) 中第一个等于 c 的字符位置，找不到返回 end
+const char* scanChar(const char* p, const char* end, char c);
+
+// 当前使用的实现名称："avx2"、"sse4.2" 或 "scalar"
+const char* scanImplName();
+
+#endif // HTTPSCAN_H
@@ -0,0 +1,55 @@
+#ifndef JSONFIELDS_H
+#define JSONFIELDS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "Arena.h"
+
+// 固定格式请求体的轻量解码：只认顶层对象里的几个字符串字段，不建 DOM、不抛异常。
+// 整个请求体按 JSON 语法完整校验（含 UTF-8 与转义），未列出的字段校验后跳过；
+// 字段值为指向请求体的视图，只有含转义的字符串才解码到 arena 中。重复的键以最后一次为准。
+
+enum class JsonFieldError : uint8_t {
+    Ok = 0,
+    Syntax,       // 不是合法 JSON（含非法转义、非法 UTF-8、嵌套过深、尾部多余内容）
+    NotObject,    // 顶层不是对象
+    MissingField, // 必需字段缺失
+    WrongType     // 字段存在但不是字符串
+};
+
+struct JsonStringField {
+    std::string_view name;
+    std::string_view value; // 请求体或 arena 中的视图，生命周期同两者中较短的一个
+    bool found = false;
+    bool isString = false;  // 找到但类型不是字符串时为 false
+};
+
+struct JsonFieldResult {
+    JsonFieldError error = JsonFieldError::Ok;
+    std::string_view field; // MissingField / WrongType 时为字段名
+    size_t offset = 0;      // Syntax 时为出错位置
+};
+
+// 提取 fields 中列出的字符串字段（全部必需）
+JsonFieldResult decodeStringFields(std::string_view body, JsonStringField* fields, size_t count, Arena& arena);
+
+// 把错误码写成可直接返回给客户端的 JSON 响应体，返回长度
+size_t formatJsonFieldError(const JsonFieldResult& result, char* out, size_t cap);
+
+// /api/login：{"email": "...", "password": "..."}
+struct LoginBody {
+    std::string_view email;
+    std::string_view password;
+};
+JsonFieldResult decodeLoginBody(std::string_view body, Arena& arena, LoginBody& out);
+
+// /api/register：{"name": "...", "email": "...", "password": "..."}
+struct SignUpBody {
+    std::string_view name;
+    std::string_view email;
+    std::string_view password;
+};
+JsonFieldResult decodeSignUpBody(std::string_view body, Arena& arena, SignUpBody& out);
+
+#endif // JSONFIELDS_H
@@ -4,11 +4,14 @@
 #include <string>
 #include <memory>
 #include <iostream>
-#include <queue>
+#include <vector>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
 #include <chrono>
+#include <cstdint>
+#include <functional>
+#include <atomic>
 #include <mysql_driver.h>
 #include <mysql_connection.h>
 #include <cppconn/prepared_statement.h>
@@ -23,61 +26,177 @@ enum class SignUpResult {
     Success = 0,
     EmailExists = 1,
     DbError = -1,
+    PoolTimeout = -2, // 在期限内借不到连接，调用方应返回 503
 };
 
 std::string GetInitName();
 SignUpResult GetSignUpResult(const UserInfo& userInfo);
-UserInfo QueryUserInfoByEmail(const std::string& email);
+// 借连接超时时返回空 UserInfo，并置 *poolTimeout = true
+UserInfo QueryUserInfoByEmail(const std::string& email, bool* poolTimeout = nullptr);
+// 启动阶段（及后台线程）借连接的期限，比请求路径上的默认期限宽松
+constexpr std::chrono::milliseconds kStartupCheckoutTimeout{5000};
+
+// sys_user 行数，失败返回 -1
+long long CountRegisteredUsers();
+// 按主键顺序分页遍历 id > afterId 的已注册邮箱（visit 收到 id 与邮箱），失败返回 false。
+// 启动时全量扫描用默认的宽松期限；后台周期性的增量扫描应传入较短的借连接期限，避免与请求争抢连接
+bool ForEachRegisteredEmail(const std::function<void(uint64_t id, const std::string& email)>& visit,
+                            uint64_t afterId = 0,
+                            std::chrono::milliseconds checkoutTimeout = kStartupCheckoutTimeout);
+
+// 签名 token 的撤销记录（sys_token_revocation，建表语句见 README），供多个后端进程共享登出。
+// 这几条语句只在登出与后台同步时执行，不放进每条连接预编译的语句表：
+// 未启用签名 token 的部署可以不建该表，也不影响连接创建。
+struct TokenRevocationRow {
+    uint64_t id = 0;
+    uint64_t nonce = 0;
+    uint32_t expireAt = 0; // Unix 秒
+};
+// 写入一条撤销记录（nonce 已存在时忽略）；借不到连接时置 *poolTimeout = true。失败返回 false
+bool InsertTokenRevocation(uint64_t nonce, uint32_t expireAt, bool* poolTimeout = nullptr);
+// 按主键顺序分页遍历 id > afterId 且 expire_at > now 的撤销记录，失败返回 false
+bool ForEachTokenRevocation(uint64_t afterId, uint32_t now,
+                            const std::function<void(const TokenRevocationRow&)>& visit);
+// 删除 expire_at <= now 的撤销记录（单次最多 limit 行），返回删除行数，失败返回 -1
+long long PurgeExpiredTokenRevocations(uint32_t now, int limit);
+
+// 预编译语句 ID：每条池化连接在创建时统一 prepare，借出后按 ID 直接取用，
+// 省去每次请求的 prepare 往返与服务端解析。新增语句时同步修改 MySQLProc.cpp 中的 SQL 表。
+enum class StmtId : uint8_t {
+    InsertUser,       // INSERT INTO sys_user (username, email, password_hash) VALUES (?, ?, ?)
+    QueryUserByEmail, // SELECT username AS name, email, password_hash FROM sys_user WHERE email = ?
+    CountUsers,       // SELECT COUNT(*) FROM sys_user
+    ScanUserEmails,   // SELECT id, email FROM sys_user WHERE id > ? ORDER BY id LIMIT ?
+    Count
+};
+
+// 池中的一条连接及其预编译语句（语句先于连接析构）。
+// 对象在 init 时按槽位一次性分配、直到池析构才释放，借还只传裸指针。
+struct PooledConnection {
+    std::unique_ptr<sql::Connection> conn;
+    std::unique_ptr<sql::PreparedStatement> statements[static_cast<size_t>(StmtId::Count)];
+    std::chrono::steady_clock::time_point lastUsed; // 最近一次归还时间，用于空闲探活
+    uint32_t slot = 0;                              // 在池槽位数组中的下标
+    std::atomic<uint32_t> nextFree{0};              // 空闲链表后继（槽位下标 + 1，0 表示无）
+
+    // 建连时 prepare 失败的语句为空，取用时再 prepare 一次；仍失败则抛 sql::SQLException
+    sql::PreparedStatement& statement(StmtId id);
+    // 按"语句 -> 连接"顺序释放
+    void close();
+};
 
+// 借出等待时间直方图各桶上界（微秒），另有一个 +Inf 桶；只统计走慢路径的借出
+constexpr uint32_t kPoolWaitBucketUs[] = {100, 500, 1000, 5000, 10000, 50000, 100000};
+constexpr size_t kPoolWaitBuckets = sizeof(kPoolWaitBucketUs) / sizeof(kPoolWaitBucketUs[0]) + 1;
+
+// 连接池计数器快照（/api/metrics 输出）
+struct ConnectionPoolStats {
+    int total = 0;            // 当前总连接数（含借出）
+    size_t idle = 0;          // 池中空闲连接数
+    uint64_t borrows = 0;     // 累计借出次数
+    uint64_t steals = 0;      // 本核空闲链表为空、从其他链表借出的次数
+    uint64_t validations = 0; // 累计 SELECT 1 探活次数
+    uint64_t discarded = 0;   // 探活失败或已关闭而丢弃的连接数
+    int waiters = 0;          // 当前等待连接的线程数
+    uint64_t waits = 0;       // 无空闲连接、进入等待的借出次数
+    uint64_t timeouts = 0;    // 等待超过期限而失败的次数
+    uint64_t waitHistogram[kPoolWaitBuckets] = {};
+};
+
+// 连接池：空闲连接分布在按 CPU 划分的若干无锁栈上。借出优先弹出当前 CPU 的栈，
+// 为空再依次窃取其他栈；归还压入当前 CPU 的栈。建连（driver_->connect）只在后台
+// 补充线程中进行，不持有任何借还路径上的锁。
 class ConnectionPool {
 public:
     // 获取单例实例
     static ConnectionPool& instance();
-    // 初始化（原构造函数逻辑迁移到此）
+    // 初始化（原构造函数逻辑迁移到此）。shutdown 后可再次 init，前提是连接已全部归还
     static void init(const std::string& host,
                      const std::string& user,
                      const std::string& password,
                      const std::string& database,
                      int maxConnections = 10,
-                     int minConnections = 2);
+                     int minConnections = 2,
+                     int idleCheckMs = 30000,
+                     int checkoutTimeoutMs = 50);
 
     ~ConnectionPool();
 
-    // 从池中获取一个连接（shared_ptr）
-    std::shared_ptr<sql::Connection> getConnection();
+    // 从池中获取一个连接；无空闲连接时最多等待 timeout，超时或池关闭返回 nullptr
+    PooledConnection* getConnection(std::chrono::milliseconds timeout);
+    // 使用 init 配置的默认期限
+    PooledConnection* getConnection() { return getConnection(checkoutTimeout_); }
 
     // 归还连接
-    void returnConnection(std::shared_ptr<sql::Connection> conn);
+    void returnConnection(PooledConnection* conn);
 
     // 关闭连接池
     void shutdown();
 
+    ConnectionPoolStats stats();
+
     ConnectionPool(const ConnectionPool&) = delete;
     ConnectionPool& operator=(const ConnectionPool&) = delete;
 
 private:
     ConnectionPool() = default; // 私有构造，使用init完成初始化
 
-    // 创建一个新连接并放入队列
-    void createConnection();
-
-    // 验证连接是否有效
-    bool isConnectionValid(std::shared_ptr<sql::Connection> conn);
-
-    // 动态扩展连接池
-    bool canExpandPool();
+    // 空闲链表：head 低 32 位为栈顶槽位下标 + 1（0 为空），高 32 位为防 ABA 的版本号
+    struct alignas(64) FreeList {
+        std::atomic<uint64_t> head{0};
+        std::atomic<int64_t> idle{0};
+        std::atomic<uint64_t> borrows{0};
+        std::atomic<uint64_t> steals{0};
+    };
+
+    FreeList& homeList();
+    void push(FreeList& list, PooledConnection* conn);
+    PooledConnection* pop(FreeList& list);
+    // 当前 CPU 的栈 -> 其余栈，均为空返回 nullptr
+    PooledConnection* tryAcquire();
+    size_t idleCount() const;
+
+    // 在 slot 上建立连接并预编译全部语句；仅建连失败时抛 sql::SQLException，
+    // 单条语句 prepare 失败只记日志并留空该语句。不持锁调用
+    void createConnection(PooledConnection& slot);
+    // 关闭连接、槽位交还补充线程
+    void discard(PooledConnection* conn);
+
+    // 验证连接是否有效（一次 SELECT 1 往返，不持锁调用）
+    bool isConnectionValid(PooledConnection& conn);
+
+    // 后台补充线程：保持至少 minConnections_ 条连接，有等待者时扩容到 maxConnections_
+    void fillLoop();
+    void recordWait(std::chrono::steady_clock::duration waited);
 
 private:
-    std::queue<std::shared_ptr<sql::Connection>> connections_;
+    std::vector<std::unique_ptr<PooledConnection>> slots_;
+    std::unique_ptr<FreeList[]> lists_;
+    size_t listCount_{0};
+
+    // 慢路径：无空闲连接时的等待、空槽位与补充线程
     std::mutex mutex_;
-    std::condition_variable condVar_;
+    std::condition_variable condVar_;   // 等待空闲连接
+    std::condition_variable fillCond_;  // 唤醒补充线程
+    std::vector<uint32_t> emptySlots_;  // 尚未建立连接的槽位，受 mutex_ 保护
+    std::atomic<int> waiters_{0};
+    std::thread filler_;
 
     sql::Driver* driver_{nullptr};
 
-    bool isRunning_{false};
+    std::atomic<bool> isRunning_{false};
     int maxConnections_{0};
     int minConnections_{0};
-    int currentConnections_{0}; // 当前总连接数
+    std::atomic<int> currentConnections_{0}; // 当前总连接数
+    // 空闲超过该时长的连接在借出前才做探活；归还时不再探活
+    std::chrono::milliseconds idleCheck_{30000};
+    std::chrono::milliseconds checkoutTimeout_{50};
+
+    std::atomic<uint64_t> validations_{0};
+    std::atomic<uint64_t> discarded_{0};
+    std::atomic<uint64_t> waits_{0};
+    std::atomic<uint64_t> timeouts_{0};
+    std::atomic<uint64_t> waitHistogram_[kPoolWaitBuckets] = {};
 
     // 记录数据库配置信息
     std::string host_;
@@ -86,22 +205,14 @@ private:
     std::string database_;
 };
 
+// 借出期限内拿不到连接时 operator bool 为 false，调用方需检查后再使用
 class ConnectionPoolAgent {
 public:
-    explicit ConnectionPoolAgent(ConnectionPool* pool,
-                                 int retryIntervalMs = 10)
-        : pool_(pool)
-    {
-        while (pool_) {
-            conn_ = pool_->getConnection();
-            if (conn_) break;
-
-            // 没拿到就睡一会再试，避免空转占满CPU
-            std::this_thread::sleep_for(
-                std::chrono::milliseconds(retryIntervalMs)
-            );
-        }
-    }
+    explicit ConnectionPoolAgent(ConnectionPool* pool)
+        : pool_(pool), conn_(pool ? pool->getConnection() : nullptr) {}
+
+    ConnectionPoolAgent(ConnectionPool* pool, std::chrono::milliseconds timeout)
+        : pool_(pool), conn_(pool ? pool->getConnection(timeout) : nullptr) {}
 
     ~ConnectionPoolAgent() {
         if (pool_ && conn_) {
@@ -109,12 +220,17 @@ public:
         }
     }
 
-    sql::Connection* operator->() { return conn_.get(); }
+    ConnectionPoolAgent(const ConnectionPoolAgent&) = delete;
+    ConnectionPoolAgent& operator=(const ConnectionPoolAgent&) = delete;
+
+    sql::Connection* operator->() { return conn_->conn.get(); }
     explicit operator bool() const { return conn_ != nullptr; }
+    // 取该连接上已预编译好的语句
+    sql::PreparedStatement& statement(StmtId id) { return conn_->statement(id); }
 
 private:
     ConnectionPool* pool_;
-    std::shared_ptr<sql::Connection> conn_;
+    PooledConnection* conn_{nullptr};
 };
 
 #endif // MYSQLPROC_H
\ No newline at end of file
@@ -0,0 +1,14 @@
+#ifndef PASSWORDCRYPT_H
+#define PASSWORDCRYPT_H
+
+#include <string>
+
+// 密码哈希层：基于 crypt_rn（libxcrypt）/ crypt_r，线程安全。
+// 每个线程首次调用时分配一份 crypt_data 并在之后复用，不同线程可并行计算 bcrypt。
+
+// 加密密码：返回哈希值（含算法、cost 与盐值），失败时抛出 std::runtime_error
+std::string hashPassword(const std::string& password, int cost = 12);
+// 验证密码：对比输入密码与存储的哈希值
+bool verifyPassword(const std::string& inputPassword, const std::string& storedHash);
+
+#endif // PASSWORDCRYPT_H
@@ -0,0 +1,26 @@
+#ifndef RESPONDER_H
+#define RESPONDER_H
+
+#include <string_view>
+
+// 响应回写句柄：只含两个指针，可按值复制、跨线程调用；每个请求只生效一次。
+// 连接层负责构造；业务层按值保存后可在其他线程（如密码哈希线程）完成回写
+class Responder {
+public:
+    using SendFn = void (*)(void* ctx, int statusCode, std::string_view body, std::string_view extraHeaders);
+
+    Responder(void* ctx, SendFn fn) : ctx_(ctx), fn_(fn) {}
+
+    void operator()(int statusCode, std::string_view body) const { fn_(ctx_, statusCode, body, std::string_view()); }
+    // extraHeaders 为完整的头部行（每行以 "\r\n" 结尾），如 "Allow: GET, POST\r\n"
+    void send(int statusCode, std::string_view body, std::string_view extraHeaders) const
+    {
+        fn_(ctx_, statusCode, body, extraHeaders);
+    }
+
+private:
+    void* ctx_;
+    SendFn fn_;
+};
+
+#endif // RESPONDER_H
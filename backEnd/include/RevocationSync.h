@@ -0,0 +1,50 @@
+#ifndef REVOCATIONSYNC_H
+#define REVOCATIONSYNC_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "TokenSigner.h"
+
+// 签名 token 撤销表的跨进程同步（仅在 TokenSigner 启用时使用）：
+// 登出先写入数据库中的共享撤销表，成功后再记入本进程；后台线程按周期增量拉取其他进程写入的记录。
+// 启动时全量加载未过期的记录，因此重启后已登出的 token 依然无效。
+// 其他进程最多在一个同步周期后拒绝已登出的 token。
+class RevocationSync {
+public:
+    static RevocationSync& instance();
+
+    // 全量加载后启动后台线程；加载失败返回 false（线程照常启动，下个周期重试）。重复调用无效
+    bool start(std::chrono::milliseconds interval = std::chrono::milliseconds(1000));
+    void stop();
+
+    // 登出：写入共享撤销表并记入本进程。写库失败返回 false，此时 token 在所有进程中都仍有效，
+    // 调用方应让客户端重试；借不到连接时置 *poolTimeout = true
+    bool publish(const TokenSigner::Revocation& r, bool* poolTimeout = nullptr);
+
+    RevocationSync(const RevocationSync&) = delete;
+    RevocationSync& operator=(const RevocationSync&) = delete;
+
+private:
+    RevocationSync() = default;
+    ~RevocationSync();
+
+    // 拉取 id 大于游标的记录并记入本进程，仅由后台线程（或 start）调用
+    bool pull();
+    void run(std::chrono::milliseconds interval);
+
+    // 自增 id 的分配与提交顺序不一定一致（多个进程并发写入），游标落后一个周期：
+    // 每次从上上次看到的最大 id 之后拉取，稍晚提交的较小 id 在下个周期仍会被看到
+    uint64_t cursor_{0};
+    uint64_t lastMaxId_{0};
+    std::chrono::steady_clock::time_point lastPurge_;
+
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool running_{false};
+};
+
+#endif // REVOCATIONSYNC_H
@@ -0,0 +1,132 @@
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ConnectProc.h"
+
+enum class HttpMethod : uint8_t {
+    Get = 0,
+    Post,
+    Put,
+    Delete,
+    Patch,
+    Head,
+    Options,
+    Unknown,
+    Count
+};
+
+HttpMethod methodFromString(std::string_view method);
+const char* methodToString(HttpMethod method);
+
+// 路径参数，如 /api/user/:id 中的 id；值为指向请求路径的视图
+struct RouteParams {
+    static const size_t kMaxParams = 8;
+    std::string_view names[kMaxParams];
+    std::string_view values[kMaxParams];
+    size_t count = 0;
+
+    std::string_view get(std::string_view name) const;
+};
+
+using RouteHandler = void (*)(const HttpRequest& req, const RouteParams& params, const Responder& respond);
+
+// 路由定义：pattern 以 '/' 开头，":name" 段为路径参数
+struct RouteDef {
+    HttpMethod method;
+    std::string_view pattern;
+    RouteHandler handler;
+};
+
+struct RouteMatch {
+    enum class Status { Found, NotFound, MethodNotAllowed };
+    Status status = Status::NotFound;
+    RouteHandler handler = nullptr;
+    int routeId = -1;           // 在路由表中的下标
+    uint32_t allowedMethods = 0; // MethodNotAllowed 时可用的方法位图
+};
+
+constexpr uint64_t routeHash(std::string_view s, uint64_t seed)
+{
+    // FNV-1a，带种子以便构建无冲突表
+    uint64_t h = 1469598103934665603ULL ^ seed;
+    for (char c : s) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+constexpr bool isParamPattern(std::string_view pattern)
+{
+    for (size_t i = 0; i + 1 < pattern.size(); ++i) {
+        if (pattern[i] == '/' && pattern[i + 1] == ':') return true;
+    }
+    return false;
+}
+
+// 编译期检查路由表：pattern 以 '/' 开头，且没有重复的 (method, pattern)
+template <size_t N>
+constexpr bool routesAreValid(const RouteDef (&routes)[N])
+{
+    for (size_t i = 0; i < N; ++i) {
+        if (routes[i].pattern.empty() || routes[i].pattern[0] != '/') return false;
+        if (routes[i].handler == nullptr || routes[i].method == HttpMethod::Unknown) return false;
+        for (size_t j = i + 1; j < N; ++j) {
+            if (routes[i].method == routes[j].method && routes[i].pattern == routes[j].pattern) return false;
+        }
+    }
+    return true;
+}
+
+// 路由分发：静态路径走无冲突哈希表（一次哈希 + 一次比较），
+// 含参数的路径走按段组织的前缀树（代价只与路径段数有关），均与路由数量无关。
+// 表在构造时一次建好，之后只读，可被多个线程同时查询。
+class Router {
+public:
+    template <size_t N>
+    explicit Router(const RouteDef (&routes)[N]) : Router(routes, N) {}
+    Router(const RouteDef* routes, size_t count);
+
+    // path 可带查询串，匹配时忽略 '?' 之后的部分
+    RouteMatch match(std::string_view method, std::string_view path, RouteParams& params) const;
+
+    const RouteDef& route(int routeId) const { return routes_[static_cast<size_t>(routeId)]; }
+
+private:
+    static const size_t kMethods = static_cast<size_t>(HttpMethod::Count);
+
+    struct MethodSet {
+        int16_t routeIds[kMethods];
+        uint32_t mask = 0;
+        MethodSet();
+    };
+    struct StaticSlot {
+        std::string_view path;
+        bool used = false;
+        MethodSet methods;
+    };
+    struct TrieNode {
+        std::unordered_map<std::string_view, int> children; // 静态段 -> 子节点
+        int paramChild = -1;
+        std::string_view paramName;
+        MethodSet methods;
+    };
+
+    void buildStaticTable();
+    void addParamRoute(int routeId);
+    RouteMatch resolve(const MethodSet& set, HttpMethod method) const;
+
+    std::vector<RouteDef> routes_;
+    std::vector<StaticSlot> slots_;
+    uint64_t seed_ = 0;
+    uint64_t mask_ = 0;
+    std::vector<TrieNode> trie_;
+};
+
+#endif // ROUTER_H
@@ -0,0 +1,76 @@
+#ifndef SESSIONSNAPSHOT_H
+#define SESSIONSNAPSHOT_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "SessionStore.h"
+
+// 会话快照：重启后恢复登录态，避免发布时所有用户重新登录（每次登录都要一次 bcrypt）。
+//
+// 文件格式（本机字节序）：8 字节文件头 "WSSNAP01"，之后是连续的记录
+//   [类型 1B: 1=写入 2=删除 3=续期][过期时间 8B: Unix 秒][token 长度 2B][email 长度 2B][token][email]
+// 运行时只追加：SessionStore 的写入/删除/续期先进入内存缓冲，后台线程按周期批量追加到文件末尾。
+// 续期记录不带 email，只更新已有会话的过期时间；SessionStore 对每个会话每分钟最多通知一次。
+// 追加的记录数超过存活会话数（文件一半以上是过期或被覆盖的记录），或距上次压缩超过
+// compactInterval 时，后台把当前全部会话写成新文件再 rename 覆盖（顺带保存滑动续期后的过期时间）。
+// 追加失败（写入或 fdatasync 出错）后不再向该文件追加，下个周期立即压缩，用内存中的会话补回丢失的批次。
+// token 或 email 超过 65535 字节的会话不落盘。
+// 启动时用 mmap 顺序回放，末尾被截断的半条记录直接忽略。
+class SessionSnapshot : public SessionStore::Listener {
+public:
+    explicit SessionSnapshot(SessionStore& store);
+    ~SessionSnapshot() override;
+
+    // 在监听端口之前调用：从 path 恢复会话，返回恢复的数量；文件不存在时返回 0
+    size_t load(const std::string& path);
+    // 开始记录变更并启动后台线程；flushInterval 为追加周期
+    bool start(const std::string& path,
+               std::chrono::milliseconds flushInterval = std::chrono::seconds(1),
+               std::chrono::seconds compactInterval = std::chrono::minutes(10));
+    // 停止后台线程，并把缓冲中剩余的变更写入文件
+    void stop();
+
+    void onPut(const Session& session) override;
+    void onErase(const std::string& token) override;
+    void onTouch(const std::string& token, SessionStore::Clock::time_point expireAt) override;
+
+    SessionSnapshot(const SessionSnapshot&) = delete;
+    SessionSnapshot& operator=(const SessionSnapshot&) = delete;
+
+private:
+    enum RecordType : uint8_t { kPut = 1, kErase = 2, kTouch = 3 };
+
+    // 字段超长时不编码，返回 false
+    static bool appendRecord(std::string& out, RecordType type, int64_t expireAt,
+                             const std::string& token, const std::string& email);
+    void run();
+    // 将缓冲中的变更追加到文件，仅由后台线程（或 stop）调用
+    bool flushPending();
+    // 重写整个文件，仅由后台线程调用
+    bool compact();
+
+    SessionStore& store_;
+    std::string path_;
+    int fd_{-1};
+    size_t appendedRecords_{0}; // 自上次压缩以来追加的记录数
+    size_t liveRecords_{0};     // 上次压缩时写入的会话数
+    bool needsCompact_{false};  // 追加失败或压缩未完成，文件不可再追加
+
+    std::mutex pendingMutex_;
+    std::string pending_;       // 待追加的已编码记录
+    size_t pendingRecords_{0};
+
+    std::thread worker_;
+    std::mutex workerMutex_;
+    std::condition_variable workerCv_;
+    bool running_{false};
+    std::chrono::milliseconds flushInterval_{1000};
+    std::chrono::seconds compactInterval_{600};
+};
+
+#endif // SESSIONSNAPSHOT_H
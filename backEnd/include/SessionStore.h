@@ -0,0 +1,114 @@
+#ifndef SESSIONSTORE_H
+#define SESSIONSTORE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct Session {
+    std::string token;
+    std::chrono::steady_clock::time_point expireAt;
+    std::string email;
+};
+
+// 分片会话存储：按 token 哈希选择分片，每个分片独立加锁，
+// 登录、登出与 token 校验只在各自分片上互斥，不再争用同一把全局锁。
+//
+// 过期：所有会话使用同一 TTL，且每次校验成功都会续期（滑动过期），
+// 因此"按过期时间排序"等价于"按最近使用排序"。每个分片用一条侵入式双向链表维护该顺序：
+// 写入/续期把节点移到表尾，过期只需从表头弹出，均为 O(1)，续期不分配内存，也无需扫描全表。
+class SessionStore {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // 变更监听（用于持久化）：回调在分片锁内执行，实现必须足够轻量
+    class Listener {
+    public:
+        virtual ~Listener() = default;
+        virtual void onPut(const Session& session) = 0;
+        virtual void onErase(const std::string& token) = 0;
+        // 校验时的滑动续期；同一会话距上次通知不足 kTouchInterval 的续期不通知
+        virtual void onTouch(const std::string& token, Clock::time_point expireAt) = 0;
+    };
+
+    // 续期通知的最小间隔：持久化的过期时间最多比内存中早这么久
+    static constexpr std::chrono::seconds kTouchInterval{60};
+
+    // 全局实例，分片数按 CPU 核数确定，TTL 1 小时
+    static SessionStore& instance();
+
+    // shardCount 为 0 时取 CPU 核数的 4 倍，最终向上取 2 的幂
+    explicit SessionStore(size_t shardCount = 0, Clock::duration ttl = std::chrono::hours(1));
+    ~SessionStore();
+
+    // 写入（已存在则覆盖），过期时间统一设为 now + ttl
+    void put(const std::string& token, Session session);
+    // 校验 token：存在且未过期返回 true 并续期；已过期的会话顺带删除
+    bool validate(const std::string& token, std::string* emailOut = nullptr);
+    // 删除会话，原本存在时返回 true
+    bool erase(const std::string& token);
+
+    // 删除所有已过期会话，返回删除数量；每个分片只处理表头的过期节点
+    size_t sweepExpired(Clock::time_point now = Clock::now());
+    // 启动后台清理线程，按 interval 周期调用 sweepExpired；重复调用无效
+    void startSweeper(Clock::duration interval = std::chrono::seconds(1));
+    void stopSweeper();
+
+    void setListener(Listener* listener) { listener_.store(listener, std::memory_order_release); }
+    // 启动时恢复会话：保留各自的 expireAt（跳过已过期的），按过期时间排序后插入以维持链表顺序
+    size_t restore(std::vector<Session> sessions);
+    // 复制所有未过期会话（用于生成快照），逐个分片加锁
+    void collect(std::vector<Session>& out) const;
+
+    size_t size() const;
+    size_t shardCount() const { return shardMask_ + 1; }
+    Clock::duration ttl() const { return ttl_; }
+
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+
+private:
+    // map 节点地址稳定，链表直接串联 Entry，不额外分配节点
+    struct Entry {
+        Session session;
+        Clock::time_point notifiedAt; // 最近一次把过期时间通知给监听者的时刻
+        const std::string* key = nullptr;
+        Entry* prev = nullptr;
+        Entry* next = nullptr;
+    };
+
+    // 独占缓存行，避免相邻分片的锁互相伪共享
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Entry> sessions;
+        Entry* head = nullptr; // 最早过期
+        Entry* tail = nullptr; // 最晚过期
+    };
+
+    Shard& shardFor(const std::string& token) const;
+    static void unlink(Shard& shard, Entry* e);
+    static void pushBack(Shard& shard, Entry* e);
+    // 调用方持有分片锁；最多删除 limit 个过期会话（0 表示不限）
+    static size_t expireLocked(Shard& shard, Clock::time_point now, size_t limit);
+
+    std::unique_ptr<Shard[]> shards_;
+    size_t shardMask_{0};
+    unsigned shardShift_{0};
+    Clock::duration ttl_;
+    std::atomic<Listener*> listener_{nullptr};
+
+    std::thread sweeper_;
+    std::mutex sweeperMutex_;
+    std::condition_variable sweeperCv_;
+    bool sweeperRunning_{false};
+};
+
+#endif // SESSIONSTORE_H
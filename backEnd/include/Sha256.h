@@ -0,0 +1,47 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// SHA-256（FIPS 180-4）与 HMAC-SHA256（RFC 2104）的最小实现，仅用于 token 签名，
+// 避免为此额外依赖 OpenSSL。
+class Sha256 {
+public:
+    static constexpr size_t kDigestSize = 32;
+    static constexpr size_t kBlockSize = 64;
+
+    Sha256();
+    void update(const void* data, size_t len);
+    void final(uint8_t out[kDigestSize]);
+
+    static void hash(const void* data, size_t len, uint8_t out[kDigestSize]);
+
+private:
+    friend class HmacSha256;
+    void compress(const uint8_t block[kBlockSize]);
+
+    uint32_t state_[8];
+    uint8_t buffer_[kBlockSize];
+    size_t bufferLen_{0};
+    uint64_t totalLen_{0};
+};
+
+// 密钥在构造时预先处理成 ipad/opad 两个中间状态，之后每次计算只需从中间状态继续，
+// 短消息的一次 HMAC 只做两次压缩。对象构造后只读，可被多线程同时使用。
+class HmacSha256 {
+public:
+    explicit HmacSha256(std::string_view key);
+
+    void compute(const void* data, size_t len, uint8_t out[Sha256::kDigestSize]) const;
+
+private:
+    Sha256 inner_;
+    Sha256 outer_;
+};
+
+// 常量时间比较：耗时只与长度有关，与首个不同字节的位置无关
+bool constantTimeEqual(const uint8_t* a, const uint8_t* b, size_t len);
+
+#endif // SHA256_H
@@ -0,0 +1,69 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 线程池运行统计（等待时间指任务从入队到开始执行）
+struct ThreadPoolStats {
+    size_t threads = 0;
+    size_t pending = 0;      // 当前排队任务数
+    size_t peakPending = 0;  // 历史最大排队数
+    uint64_t submitted = 0;
+    uint64_t rejected = 0;   // 队列已满或已关闭被拒绝的任务数
+    uint64_t completed = 0;
+    uint64_t totalWaitUs = 0;
+    uint64_t maxWaitUs = 0;
+    uint64_t avgRunUs = 0;   // 任务执行耗时的滑动平均（EWMA，1/8 权重）
+};
+
+// 固定大小的工作线程池：线程在构造时一次性创建，之后只复用，不再按请求创建线程
+class ThreadPool {
+public:
+    // maxPending 为排队上限，0 表示不限
+    explicit ThreadPool(size_t threadCount, size_t maxPending = 0);
+    ~ThreadPool();
+
+    // 投递任务，池已关闭或队列已满时返回 false
+    bool submit(std::function<void()> task);
+
+    // 停止接收新任务，执行完队列中剩余任务后回收所有线程
+    void shutdown();
+
+    size_t size() const { return workers_.size(); }
+    size_t pending();
+    ThreadPoolStats stats();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+private:
+    using SteadyClock = std::chrono::steady_clock;
+
+    struct Task {
+        std::function<void()> fn;
+        SteadyClock::time_point enqueuedAt;
+    };
+
+    void workerLoop();
+
+    std::vector<std::thread> workers_;
+    std::deque<Task> tasks_;
+    std::mutex mutex_;
+    std::condition_variable condVar_;
+    bool isRunning_{true};
+    size_t maxPending_{0};
+    ThreadPoolStats stats_;
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> avgRunUs_{0};
+};
+
+#endif // THREADPOOL_H
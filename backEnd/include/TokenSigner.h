@@ -0,0 +1,102 @@
+#ifndef TOKENSIGNER_H
+#define TOKENSIGNER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Sha256.h"
+
+// 无状态签名 token（可选模式）：
+//   token = "s1." + base64url( 过期时间(4B, 大端, Unix 秒) | nonce(8B) | email | HMAC-SHA256(32B) )
+// 校验只做一次 base64url 解码和一次 HMAC（两次 SHA-256 压缩），常量时间比较，
+// 不加锁、不查会话表，因此多个后端进程共享同一密钥即可互认 token。
+// 登出通过撤销表实现：按 nonce 记录到 token 过期为止，读路径无锁，表满时扩容。
+// 撤销表本身在进程内；多进程共享与重启后的恢复由 RevocationSync 经数据库完成。
+class TokenSigner {
+public:
+    static constexpr std::string_view kPrefix = "s1.";
+    static constexpr size_t kMaxEmailBytes = 254;
+
+    // 一条撤销记录，也是跨进程同步的单位
+    struct Revocation {
+        uint64_t nonce = 0;
+        uint32_t expireAt = 0; // Unix 秒，与 token 的过期时间相同
+    };
+
+    // 启用签名模式；secret 建议至少 32 字节随机数据；revocationCapacity 为撤销表初始容量。重复调用无效
+    static void init(std::string_view secret,
+                     std::chrono::seconds ttl = std::chrono::hours(1),
+                     size_t revocationCapacity = 1 << 16);
+    static bool enabled() { return instance_ != nullptr; }
+    // 仅在 enabled() 时可用
+    static TokenSigner& instance() { return *instance_; }
+
+    // 按前缀区分签名 token 与旧的会话 token
+    static bool looksSigned(std::string_view token) { return token.substr(0, kPrefix.size()) == kPrefix; }
+
+    // 签发 token；email 超过 kMaxEmailBytes 时抛出 std::invalid_argument
+    std::string issue(std::string_view email) const;
+    // 校验签名、过期时间与撤销表
+    bool verify(std::string_view token, std::string* emailOut = nullptr) const;
+    // 撤销（登出）：token 有效时记入撤销表并返回 true；不会因撤销表已满而失败
+    bool revoke(std::string_view token);
+    // 校验 token 有效（签名、过期、未撤销）并取出其撤销记录，不修改撤销表
+    bool revocationOf(std::string_view token, Revocation& out) const;
+    // 记入撤销表（本进程登出，或从其他进程同步来的记录）；已过期或已存在时返回 false
+    bool applyRevocation(const Revocation& r);
+
+    TokenSigner(const TokenSigner&) = delete;
+    TokenSigner& operator=(const TokenSigner&) = delete;
+
+private:
+    TokenSigner(std::string_view secret, std::chrono::seconds ttl, size_t revocationCapacity);
+
+    struct Claims {
+        uint32_t expireAt;
+        uint64_t nonce;
+        std::string_view email; // 指向调用方的解码缓冲区
+    };
+    // 解码并校验签名与过期时间；buf 至少 kMaxTokenBytes 字节
+    bool decode(std::string_view token, uint8_t* buf, Claims& claims) const;
+    bool isRevoked(uint64_t nonce) const;
+
+    struct RevokedTable;
+    // 以下均在 revokeMutex_ 内调用。插入失败（探测窗口内没有可用槽位）时返回 false
+    static bool insertLocked(RevokedTable& table, uint64_t nonce, uint32_t expireAt, uint32_t now);
+    // 换成容量翻倍的新表，只搬迁未过期的记录
+    void growLocked(uint32_t now);
+
+    static constexpr size_t kHeaderBytes = 12;
+    static constexpr size_t kMaxTokenBytes = kHeaderBytes + kMaxEmailBytes + Sha256::kDigestSize;
+    static constexpr size_t kMaxProbe = 32;
+
+    // 撤销表：开放寻址，nonce 为 0 表示空槽。读只看 nonce（原子读、无锁），
+    // 写在 revokeMutex_ 下进行，可复用 token 已过期的槽位，因此探测链不会出现空洞。
+    // 探测窗口内没有可用槽位时整体换成两倍大小的新表后再插入；读端可能仍在旧表上探测，
+    // 旧表不再写入、保留到对象析构（容量逐次翻倍，旧表合计不超过当前表）。
+    struct RevokedSlot {
+        std::atomic<uint64_t> nonce{0};
+        uint32_t expireAt = 0; // 仅写端在锁内读写
+    };
+    struct RevokedTable {
+        explicit RevokedTable(size_t capacity) : slots(new RevokedSlot[capacity]), mask(capacity - 1) {}
+        std::unique_ptr<RevokedSlot[]> slots;
+        size_t mask;
+    };
+
+    static std::unique_ptr<TokenSigner> instance_;
+
+    HmacSha256 hmac_;
+    std::chrono::seconds ttl_;
+    std::atomic<RevokedTable*> revoked_{nullptr};
+    std::vector<std::unique_ptr<RevokedTable>> revokedTables_; // 当前表与历次扩容前的旧表
+    std::mutex revokeMutex_;
+};
+
+#endif // TOKENSIGNER_H
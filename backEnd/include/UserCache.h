@@ -0,0 +1,70 @@
+#ifndef USERCACHE_H
+#define USERCACHE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "MySQLProc.h"
+
+// 用户信息缓存统计
+struct UserCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0; // 容量淘汰（不含 TTL 过期）
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+// 按 email 缓存 UserInfo 的分片 LRU（带 TTL），放在 QueryUserInfoByEmail 之前：
+// 同一账号在多个设备上反复登录时不必每次都借连接、查 MySQL。
+// 只缓存查到的用户；注册成功后按 email 失效。
+class UserCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // 必须在首次 instance() 之前调用才生效；未调用时使用默认值（1 万条、5 分钟）
+    static void init(size_t capacity, std::chrono::seconds ttl);
+    static UserCache& instance();
+
+    UserCache(size_t capacity, Clock::duration ttl, size_t shardCount = 16);
+
+    // 命中且未过期时拷贝到 out 并返回 true
+    bool get(const std::string& email, UserInfo& out);
+    void put(const UserInfo& info);
+    void invalidate(const std::string& email);
+
+    UserCacheStats stats() const;
+
+    UserCache(const UserCache&) = delete;
+    UserCache& operator=(const UserCache&) = delete;
+
+private:
+    struct Node {
+        UserInfo info;
+        Clock::time_point expireAt;
+    };
+
+    // 独占缓存行，避免相邻分片的锁互相伪共享
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::list<Node> lru; // 表头为最近使用
+        std::unordered_map<std::string, std::list<Node>::iterator> index;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    Shard& shardFor(const std::string& email);
+
+    std::unique_ptr<Shard[]> shards_;
+    size_t shardCount_;
+    size_t shardCapacity_;
+    Clock::duration ttl_;
+};
+
+#endif // USERCACHE_H
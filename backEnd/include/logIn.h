@@ -13,8 +13,10 @@
 #define LOGIN_H
 
 #include <string>
+#include <string_view>
 #include <functional>
 #include "MySQLProc.h"
+#include "Responder.h"
 // 新增: 生成简单的 token（时间戳 + 随机数 + email 进行 Base64）
 #include <chrono>
 #include <random>
@@ -23,21 +25,12 @@
 #include <unordered_map>
 #include <mutex>
 
-struct Session {
-    std::string token;
-    std::chrono::steady_clock::time_point expireAt;
-    std::string email;
-};
-extern std::unordered_map<std::string, Session> g_sessionStore; // 全局会话存储
-extern std::mutex g_sessionMutex; // 访问会话存储的互斥锁
+#include "SessionStore.h" // 全局会话存储（分片加锁）
 
 
-// 验证密码：对比输入密码与存储的哈希值
-bool verifyPassword(const std::string& inputPassword, const std::string& storedHash);
-void handleLogInRequest(const std::string& requestBody,
-                        std::function<void(int, const std::string&)> sendResponse);
+// 密码校验在哈希线程池中异步完成，respond 可能在函数返回后才被调用
+void handleLogInRequest(std::string_view requestBody, const Responder& respond);
 // 新增: 登出与 token 验证接口
 bool validateToken(const std::string& token, std::string* emailOut = nullptr);
-void handleLogOutRequest(const std::string& token,
-                         std::function<void(int, const std::string&)> sendResponse);
+void handleLogOutRequest(std::string_view token, const Responder& sendResponse);
 #endif // LOGIN_H
\ No newline at end of file
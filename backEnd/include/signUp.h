@@ -23,11 +23,13 @@
 
 
 #include <string>
+#include <string_view>
 #include <functional>
+#include "Responder.h"
 
 
-void handleSignUpRequest(const std::string& requestBody,
-                         std::function<void(int, const std::string&)> sendResponse);
+// 哈希与入库在哈希线程池中异步完成，respond 可能在函数返回后才被调用
+void handleSignUpRequest(std::string_view requestBody, const Responder& respond);
 
 
 
@@ -1,13 +1,15 @@
 #include "logIn.h"
-#include <crypt.h>
-#include <json.hpp>
+#include "PasswordCrypt.h"
 #include "MySQLProc.h"
 #include "LogM.h"
-#include <mutex>
+#include "Arena.h"
+#include "JsonFields.h"
+#include "HashPool.h"
+#include "TokenSigner.h"
+#include "RevocationSync.h"
+#include "AccessLog.h"
 
 using namespace std;
-unordered_map<string, Session> g_sessionStore;
-std::mutex g_sessionMutex; // 新增互斥锁
 
 static std::string base64Encode(const std::string &in) {
     static const char *tbl = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
@@ -49,15 +51,6 @@ static std::string generateToken(const std::string &email) {
     return base64Encode(oss.str());
 }
 
-// 验证密码：对比输入密码与存储的哈希值
-bool verifyPassword(const std::string& inputPassword, const std::string& storedHash) {
-    // crypt 会从 storedHash 里读出算法 / cost / 盐，然后再算一次
-    const char* out = crypt(inputPassword.c_str(), storedHash.c_str());
-    if (!out) return false;
-
-    return storedHash == std::string(out);
-}
-
 void SaveInSessionCB(const string& email, const string& token) {
     // 此处应实现将 token 存储在服务器端的会话存储中，关联到对应的 email
     // 例如，可以使用内存缓存、数据库等方式存储
@@ -65,75 +58,131 @@ void SaveInSessionCB(const string& email, const string& token) {
     LOG_INFO("Saving session for email: %s with token: %s", email.c_str(), token.c_str());
     Session session;
     session.token = token;
-    session.expireAt = std::chrono::steady_clock::now() + std::chrono::hours(1); // 1小时后过期
+    // 过期时间由 SessionStore 统一设置（TTL 1 小时，使用时续期）
     session.email = email;
-    {
-        std::lock_guard<std::mutex> lk(g_sessionMutex);
-        g_sessionStore[token] = session;
-        LOG_DEBUG("Current session store size: %zu", g_sessionStore.size());
-    }
+    SessionStore::instance().put(token, std::move(session));
 }
 
-void handleLogInRequest(const std::string &requestBody, std::function<void(int, const std::string &)> sendResponse)
+void handleLogInRequest(std::string_view requestBody, const Responder& respond)
 {
-    // 解析 JSON 数据
-    nlohmann::json jsonData = nlohmann::json::parse(requestBody);
-    std::string email = jsonData["email"];
-    std::string password = jsonData["password"];
+    // 只取 email / password：字段值直接指向请求体，含转义时才解码到连接的 Arena
+    Arena fallback;
+    Arena& arena = Arena::current() ? *Arena::current() : fallback;
+    LoginBody body;
+    JsonFieldResult parsed = decodeLoginBody(requestBody, arena, body);
+    if (parsed.error != JsonFieldError::Ok) {
+        char msg[128];
+        respond(400, std::string_view(msg, formatJsonFieldError(parsed, msg, sizeof(msg))));
+        return;
+    }
+    std::string_view email = body.email;
+    std::string_view password = body.password;
 
     // 查询用户信息
-    UserInfo userInfo = QueryUserInfoByEmail(email);
-    if (userInfo.email.empty()) {
-        sendResponse(401, R"({"success": false, "message": "邮箱或密码错误"})");
+    bool poolTimeout = false;
+    UserInfo userInfo;
+    {
+        PhaseTimer timer(TracePhase::Db);
+        userInfo = QueryUserInfoByEmail(std::string(email), &poolTimeout);
+    }
+    if (poolTimeout) {
+        // 数据库连接耗尽：快速失败，不占住工作线程
+        respond.send(503, R"({"success": false, "message": "服务繁忙，请稍后重试"})", "Retry-After: 1\r\n");
         return;
     }
-
-    // 验证密码
-    if (!verifyPassword(password, userInfo.passwordHash)) {
-        sendResponse(401, R"({"success": false, "message": "邮箱或密码错误"})");
+    if (userInfo.email.empty()) {
+        respond(401, R"({"success": false, "message": "邮箱或密码错误"})");
         return;
     }
 
-    // 登录成功并生成 token
-    std::string token = generateToken(userInfo.email);
-    SaveInSessionCB(email, token);
-    nlohmann::json resp = {
-        {"success", true},
-        {"message", "登录成功"},
-        {"token", token}
-    };
-    sendResponse(200, resp.dump());
+    // 验证密码放到哈希线程池执行，本线程立即返回；此后不再触碰 Arena 中的数据
+    bool queued = HashPool::instance().submit(
+        [respond, trace = RequestTrace::current(), password = std::string(password),
+         userInfo = std::move(userInfo)]() {
+            // 计时只能在回写响应之前进行，回写后连接可能已开始处理下一条请求
+            RequestTrace::Scope scope(trace);
+            try {
+                bool verified;
+                {
+                    PhaseTimer timer(TracePhase::Bcrypt);
+                    verified = verifyPassword(password, userInfo.passwordHash);
+                }
+                if (!verified) {
+                    respond(401, R"({"success": false, "message": "邮箱或密码错误"})");
+                    return;
+                }
+
+                // 登录成功并生成 token
+                // 签名模式下 token 自带身份与过期时间，无需写会话表
+                std::string token;
+                if (TokenSigner::enabled()) {
+                    token = TokenSigner::instance().issue(userInfo.email);
+                } else {
+                    token = generateToken(userInfo.email);
+                    SaveInSessionCB(userInfo.email, token);
+                }
+                // token 为 Base64/Base64url 字符集，无需 JSON 转义
+                std::string resp;
+                resp.reserve(64 + token.size());
+                resp += R"({"success": true, "message": "登录成功", "token": ")";
+                resp += token;
+                resp += "\"}";
+                respond(200, resp);
+            } catch (const std::exception& e) {
+                LOG_ERROR("Login failed in hash pool: %s", e.what());
+                respond(500, R"({"success": false, "message": "服务器错误"})");
+            }
+        });
+    if (!queued) {
+        LOG_ERROR("Hash pool is full, login rejected");
+        respond.send(503, R"({"success": false, "message": "服务繁忙，请稍后重试"})", "Retry-After: 1\r\n");
+    }
 }
 
 // 新增: token 验证
 bool validateToken(const std::string& token, std::string* emailOut) {
     if (token.empty()) return false;
-    std::lock_guard<std::mutex> lk(g_sessionMutex);
-    auto it = g_sessionStore.find(token);
-    if (it == g_sessionStore.end()) return false;
-    // 过期检查
-    if (std::chrono::steady_clock::now() > it->second.expireAt) {
-        g_sessionStore.erase(it);
-        return false;
+    if (TokenSigner::looksSigned(token)) {
+        return TokenSigner::enabled() && TokenSigner::instance().verify(token, emailOut);
     }
-    if (emailOut) *emailOut = it->second.email;
-    return true;
+    return SessionStore::instance().validate(token, emailOut);
+}
+
+// 签名 token 登出：先写入共享撤销表，成功后才记入本进程。写库失败时 token 在所有进程中都仍有效，
+// 回 503 让客户端重试，不会出现本进程已登出、其他进程仍放行的情况
+static void handleSignedLogOut(std::string_view token, const Responder& sendResponse)
+{
+    TokenSigner::Revocation revocation;
+    if (!TokenSigner::enabled() || !TokenSigner::instance().revocationOf(token, revocation)) {
+        sendResponse(401, R"({"success": false, "message": "无效token"})");
+        return;
+    }
+    bool published;
+    {
+        PhaseTimer timer(TracePhase::Db);
+        published = RevocationSync::instance().publish(revocation);
+    }
+    if (!published) {
+        sendResponse.send(503, R"({"success": false, "message": "登出失败，请稍后重试"})", "Retry-After: 1\r\n");
+        return;
+    }
+    sendResponse(200, R"({"success": true, "message": "登出成功"})");
 }
 
 // 新增: 登出处理（删除 session）
-void handleLogOutRequest(const std::string& token, std::function<void(int, const std::string&)> sendResponse) {
+void handleLogOutRequest(std::string_view token, const Responder& sendResponse) {
     if (token.empty()) {
         sendResponse(400, R"({"success": false, "message": "缺少token"})");
         return;
     }
-    {
-        std::lock_guard<std::mutex> lk(g_sessionMutex);
-        auto it = g_sessionStore.find(token);
-        if (it == g_sessionStore.end()) {
-            sendResponse(401, R"({"success": false, "message": "无效token"})");
-            return;
-        }
-        g_sessionStore.erase(it);
+    if (TokenSigner::looksSigned(token)) {
+        handleSignedLogOut(token, sendResponse);
+        return;
+    }
+    bool removed = SessionStore::instance().erase(std::string(token));
+    if (!removed) {
+        sendResponse(401, R"({"success": false, "message": "无效token"})");
+        return;
     }
     sendResponse(200, R"({"success": true, "message": "登出成功"})");
 }
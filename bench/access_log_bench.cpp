@@ -0,0 +1,73 @@
+// 访问日志开销基准：按固定速率追加记录（模拟事件循环线程），统计调用线程与整个进程
+// （含后台编码、写文件线程）每条记录消耗的 CPU，以及该速率下占用的单核比例。
+//
+// 构建：cmake -DWEBSITE_BUILD_BENCH=ON .. && cmake --build . --target access_log_bench
+// 运行：./access_log_bench [每秒记录数=200000] [秒数=3]
+//       记录写到 ./bench_log/access.log
+#include "AccessLog.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <sys/resource.h>
+#include <thread>
+
+static double threadCpuSec()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double processCpuSec()
+{
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+int main(int argc, char** argv)
+{
+    long rate = argc > 1 ? std::atol(argv[1]) : 200000;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 3;
+    AccessLog& log = AccessLog::instance();
+    if (!log.start("./bench_log/access.log")) return 1;
+
+    // 每 1 ms 追加一批，批间 sleep，调用线程的 CPU 时间基本就是 append 本身
+    const long perBatch = rate / 1000 > 0 ? rate / 1000 : 1;
+    const long batches = static_cast<long>(seconds) * 1000;
+    AccessRecord r{};
+    r.clientIp = htonl(0x7f000001);
+    r.status = 200;
+    r.method = 1;
+    r.routeId = 0;
+
+    double cpu0 = processCpuSec();
+    double self0 = threadCpuSec();
+    auto start = std::chrono::steady_clock::now();
+    auto next = start;
+    for (long b = 0; b < batches; ++b) {
+        for (long i = 0; i < perBatch; ++i) {
+            r.startNs = std::chrono::steady_clock::now().time_since_epoch().count();
+            r.connRequest = static_cast<uint32_t>(i);
+            r.totalUs = static_cast<uint32_t>(i * 7 % 5000);
+            log.append(r);
+        }
+        next += std::chrono::milliseconds(1);
+        std::this_thread::sleep_until(next);
+    }
+    double self = threadCpuSec() - self0;
+    log.stop();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double cpu = processCpuSec() - cpu0;
+
+    double records = static_cast<double>(perBatch) * batches;
+    AccessLogStats s = log.stats();
+    std::printf("records %.0f, written %llu, dropped %llu\n", records,
+                static_cast<unsigned long long>(s.written), static_cast<unsigned long long>(s.dropped));
+    std::printf("caller  %7.1f ns/record\n", self * 1e9 / records);
+    std::printf("process %7.1f ns/record (incl. background encode + write)\n", cpu * 1e9 / records);
+    std::printf("at %ld records/s: %.2f%% of one core\n", rate, cpu / wall * 100);
+    return 0;
+}
@@ -0,0 +1,73 @@
+// bcrypt 并行校验基准：对比线程安全的 crypt_rn 路径（每线程复用 crypt_data）
+// 与"全局互斥锁 + crypt()"的串行化基线，观察随线程数增加的吞吐变化。
+//
+// 构建：cmake -DWEBSITE_BUILD_BENCH=ON .. && cmake --build . --target bcrypt_bench
+// 运行：./bcrypt_bench [cost=10] [每线程校验次数=16] [最大线程数=CPU 核数]
+#include "PasswordCrypt.h"
+#include <crypt.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::mutex g_cryptMutex;
+
+// 基线：与改造前相同的 crypt()，用互斥锁保证结果缓冲区不被并发覆盖
+static bool verifySerialized(const std::string& password, const std::string& storedHash)
+{
+    std::lock_guard<std::mutex> lk(g_cryptMutex);
+    const char* out = crypt(password.c_str(), storedHash.c_str());
+    return out && storedHash == out;
+}
+
+template <typename Verify>
+static double runOnce(int threads, int perThread, const std::string& password,
+                      const std::string& storedHash, Verify verify)
+{
+    std::atomic<int> failures{0};
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            for (int i = 0; i < perThread; ++i) {
+                if (!verify(password, storedHash)) failures.fetch_add(1);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (failures.load() != 0) {
+        std::fprintf(stderr, "verification failed %d times\n", failures.load());
+        std::exit(1);
+    }
+    return threads * perThread / sec;
+}
+
+int main(int argc, char** argv)
+{
+    int cost = argc > 1 ? std::atoi(argv[1]) : 10;
+    int perThread = argc > 2 ? std::atoi(argv[2]) : 16;
+    int maxThreads = argc > 3 ? std::atoi(argv[3]) : static_cast<int>(std::thread::hardware_concurrency());
+    if (maxThreads <= 0) maxThreads = 1;
+
+    const std::string password = "correct horse battery staple";
+    const std::string storedHash = hashPassword(password, cost);
+    std::printf("bcrypt cost %d, %d verifications per thread\n", cost, perThread);
+    std::printf("%8s %16s %16s %8s\n", "threads", "crypt_rn ops/s", "mutex ops/s", "speedup");
+
+    std::vector<int> threadCounts;
+    for (int t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    for (int threads : threadCounts) {
+        double parallel = runOnce(threads, perThread, password, storedHash, verifyPassword);
+        double serialized = runOnce(threads, perThread, password, storedHash, verifySerialized);
+        std::printf("%8d %16.1f %16.1f %7.2fx\n", threads, parallel, serialized, parallel / serialized);
+    }
+    return 0;
+}
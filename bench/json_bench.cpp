@@ -0,0 +1,73 @@
+// 登录/注册请求体解码基准：nlohmann DOM（ArenaJson::parse + get_ref，改造前的做法）
+// 与 JsonFields 按字段解码的对比；两者都从同一个 Arena 分配，每次迭代后 reset。
+//
+// 构建：cmake -DWEBSITE_BUILD_BENCH=ON .. && cmake --build . --target json_bench
+// 运行：./json_bench [迭代次数=1000000]
+#include "Arena.h"
+#include "JsonFields.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+#include <json.hpp>
+
+// 改造前请求路径上用的 DOM：节点与字符串都从当前 Arena 分配。
+// 注意：nlohmann 在销毁节点时会重新默认构造分配器，ArenaJson 对象不能离开创建它的 ArenaScope。
+using ArenaJson = nlohmann::basic_json<std::map, std::vector, ArenaString,
+                                       bool, std::int64_t, std::uint64_t, double,
+                                       ArenaAllocator>;
+
+template <typename F>
+static double nsPerOp(int iterations, Arena& arena, F&& fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+        arena.reset();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    struct Case {
+        const char* name;
+        bool signUp;
+        std::string body;
+    } cases[] = {
+        {"login", false, R"({"email": "alice@example.com", "password": "correct horse battery staple"})"},
+        {"register", true, R"({"name": "INVITE2024", "email": "alice@example.com", "password": "correct horse battery staple"})"},
+        {"login-escaped", false, R"({"email": "alice@example.com", "password": "p\"ss\\wörd"})"},
+    };
+
+    Arena arena;
+    ArenaScope scope(arena);
+    std::printf("%-14s %12s %12s %8s\n", "body", "nlohmann ns", "fields ns", "speedup");
+    for (const Case& c : cases) {
+        size_t sink = 0;
+        double dom = nsPerOp(iterations, arena, [&]() {
+            ArenaJson j = ArenaJson::parse(c.body.begin(), c.body.end());
+            sink += j["email"].get_ref<const ArenaString&>().size();
+            sink += j["password"].get_ref<const ArenaString&>().size();
+            if (c.signUp) sink += j["name"].get_ref<const ArenaString&>().size();
+        });
+        double fields = nsPerOp(iterations, arena, [&]() {
+            if (c.signUp) {
+                SignUpBody body;
+                if (decodeSignUpBody(c.body, arena, body).error == JsonFieldError::Ok) {
+                    sink += body.email.size() + body.password.size() + body.name.size();
+                }
+            } else {
+                LoginBody body;
+                if (decodeLoginBody(c.body, arena, body).error == JsonFieldError::Ok) {
+                    sink += body.email.size() + body.password.size();
+                }
+            }
+        });
+        std::printf("%-14s %12.1f %12.1f %7.1fx   (checksum %zu)\n", c.name, dom, fields, dom / fields, sink);
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+// 日志调用开销基准：多线程并发 LOG_INFO，统计调用线程侧的平均耗时与写出条数。
+//
+// 构建：cmake -DWEBSITE_BUILD_BENCH=ON .. && cmake --build . --target log_bench
+// 运行：./log_bench [每线程条数=200000] [drop]
+//       日志写到 ./bench_log/app.log，结束前 flush 保证全部落盘
+#include "LogM.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    int perThread = argc > 1 ? std::atoi(argv[1]) : 200000;
+    LogM& logger = LogM::getInstance();
+    logger.setLogFile("./bench_log/app.log");
+    logger.setMaxFileSize(static_cast<size_t>(1) << 30);
+    if (argc > 2 && std::strcmp(argv[2], "drop") == 0) {
+        logger.setOverflowPolicy(LogOverflowPolicy::Drop);
+    }
+
+    std::printf("%8s %14s %14s %10s\n", "threads", "ns/call", "calls/s", "dropped");
+    for (int threads : {1, 4, 16}) {
+        uint64_t droppedBefore = logger.droppedCount();
+        std::atomic<long long> totalNs{0};
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < perThread; ++i) {
+                    LOG_INFO("Received HTTP request: %s %s seq=%d thread=%d", "POST", "/api/login", i, t);
+                }
+                totalNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+            });
+        }
+        auto wallStart = std::chrono::steady_clock::now();
+        for (auto& w : workers) w.join();
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        logger.flush();
+        double calls = static_cast<double>(threads) * perThread;
+        std::printf("%8d %14.1f %14.0f %10llu\n", threads, totalNs.load() / calls, calls / wall,
+                    static_cast<unsigned long long>(logger.droppedCount() - droppedBefore));
+    }
+    return 0;
+}
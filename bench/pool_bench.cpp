@@ -0,0 +1,60 @@
+// 连接池吞吐基准：每次借出都探活（等价于改造前归还时 SELECT 1 的往返次数）
+// 与"仅空闲超时才探活"对比。需要一个可连接的 MySQL 实例。
+//
+// 构建：cmake -DWEBSITE_BUILD_BENCH=ON .. && cmake --build . --target pool_bench
+// 运行：./pool_bench <host> <user> <password> <database> [池大小=8] [每线程查询次数=2000]
+#include "MySQLProc.h"
+#include <cppconn/resultset.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+static double run(int threads, int perThread, int poolSize, int idleCheckMs, char** argv)
+{
+    ConnectionPool& pool = ConnectionPool::instance();
+    ConnectionPool::init(argv[1], argv[2], argv[3], argv[4], poolSize, poolSize, idleCheckMs);
+    ConnectionPoolStats before = pool.stats();
+
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            for (int i = 0; i < perThread; ++i) {
+                // 线程数多于连接数时必然排队，期限放宽到不影响吞吐测量
+                ConnectionPoolAgent agent(&pool, std::chrono::seconds(5));
+                if (!agent) continue;
+                std::unique_ptr<sql::ResultSet> rs(agent.statement(StmtId::CountUsers).executeQuery());
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ConnectionPoolStats after = pool.stats();
+    std::printf("  idleCheckMs=%-6d validations=%llu\n", idleCheckMs,
+                static_cast<unsigned long long>(after.validations - before.validations));
+    pool.shutdown();
+    return static_cast<double>(threads) * perThread / sec;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 5) {
+        std::fprintf(stderr, "usage: %s host user password database [poolSize] [perThread]\n", argv[0]);
+        return 1;
+    }
+    int poolSize = argc > 5 ? std::atoi(argv[5]) : 8;
+    int perThread = argc > 6 ? std::atoi(argv[6]) : 2000;
+
+    std::printf("pool size %d, %d queries per thread\n", poolSize, perThread);
+    for (int threads : {1, poolSize, poolSize * 4}) {
+        std::printf("%d threads\n", threads);
+        double always = run(threads, perThread, poolSize, 0, argv);
+        double idle = run(threads, perThread, poolSize, 30000, argv);
+        std::printf("  validate-every-borrow %10.0f q/s, idle-only %10.0f q/s, %5.2fx\n",
+                    always, idle, idle / always);
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+// token 校验吞吐基准：分片 SessionStore 与"单个 unordered_map + 全局互斥锁"基线对比。
+//
+// 构建：cmake -DWEBSITE_BUILD_BENCH=ON .. && cmake --build . --target session_bench
+// 运行：./session_bench [会话数=100000] [每线程校验次数=200000]
+#include "SessionStore.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// 基线：与改造前相同的全局 map + 单锁
+class GlobalLockStore {
+public:
+    void put(const std::string& token, Session session)
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        sessions_[token] = std::move(session);
+    }
+    bool validate(const std::string& token, std::string* emailOut)
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto it = sessions_.find(token);
+        if (it == sessions_.end()) return false;
+        if (std::chrono::steady_clock::now() > it->second.expireAt) {
+            sessions_.erase(it);
+            return false;
+        }
+        if (emailOut) *emailOut = it->second.email;
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<std::string, Session> sessions_;
+};
+
+template <typename Store>
+static double run(Store& store, const std::vector<std::string>& tokens, int threads, int perThread)
+{
+    std::atomic<int> misses{0};
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::string email;
+            size_t idx = static_cast<size_t>(t) * 7919;
+            for (int i = 0; i < perThread; ++i) {
+                idx = (idx + 104729) % tokens.size();
+                if (!store.validate(tokens[idx], &email)) misses.fetch_add(1);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (misses.load() != 0) {
+        std::fprintf(stderr, "unexpected misses: %d\n", misses.load());
+        std::exit(1);
+    }
+    return static_cast<double>(threads) * perThread / sec;
+}
+
+int main(int argc, char** argv)
+{
+    size_t sessions = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    int perThread = argc > 2 ? std::atoi(argv[2]) : 200000;
+
+    SessionStore sharded;
+    GlobalLockStore global;
+    std::vector<std::string> tokens;
+    tokens.reserve(sessions);
+    auto expireAt = std::chrono::steady_clock::now() + std::chrono::hours(1);
+    for (size_t i = 0; i < sessions; ++i) {
+        std::string token = "token-" + std::to_string(i * 2654435761u);
+        Session s{token, expireAt, "user" + std::to_string(i) + "@example.com"};
+        sharded.put(token, s);
+        global.put(token, std::move(s));
+        tokens.push_back(std::move(token));
+    }
+
+    std::printf("%zu sessions, %zu shards, %d validations per thread\n",
+                sessions, sharded.shardCount(), perThread);
+    std::printf("%8s %18s %18s %8s\n", "threads", "sharded ops/s", "global-lock ops/s", "speedup");
+    for (int threads : {1, 8, 32}) {
+        double a = run(sharded, tokens, threads, perThread);
+        double b = run(global, tokens, threads, perThread);
+        std::printf("%8d %18.0f %18.0f %7.2fx\n", threads, a, b, a / b);
+    }
+    return 0;
+}
@@ -0,0 +1,774 @@
+#include "LogM.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <new>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+
+// 环形缓冲区中的一条记录：头部 + 正文，总长按 8 字节对齐。
+// kText 的正文是已格式化的消息；kDeferred 的正文是 logm 编码的参数，由写线程按 fmt 格式化
+struct RecordHeader {
+    uint32_t size;    // 含头部与对齐填充的总长度
+    uint8_t kind;     // RecordKind
+    uint8_t level;
+    uint16_t reserved;
+    uint32_t msgLen;  // 正文长度
+    int32_t line;
+    int64_t timeNs;   // CLOCK_REALTIME 纳秒
+    const char* file;
+    const char* func;
+    const char* fmt;
+};
+
+enum RecordKind : uint8_t {
+    kPadding = 0, // 尾部放不下时的回绕填充，读端直接跳过
+    kText = 1,
+    kDeferred = 2,
+};
+
+constexpr size_t kRecordAlign = 8;
+constexpr size_t kDefaultThreadBuffer = 256 * 1024;
+constexpr size_t kDefaultMaxFileSize = 10 * 1024 * 1024;
+constexpr size_t kMinThreadBuffer = 64 * 1024; // 保证单条延迟记录（最多 16 个参数）放得下
+constexpr size_t kPrefixMax = 256;
+constexpr size_t kMessageMax = 512;            // 延迟格式化后的消息上限，与旧宏的缓冲区一致
+constexpr size_t kSlotSize = kPrefixMax + kMessageMax + 1;
+constexpr int kMaxIov = 1020; // 低于 IOV_MAX(1024)，每条记录最多 3 段
+constexpr auto kWriterInterval = std::chrono::milliseconds(20);
+
+size_t alignRecord(size_t n)
+{
+    return (n + kRecordAlign - 1) & ~(kRecordAlign - 1);
+}
+
+size_t roundUpPow2(size_t n)
+{
+    size_t p = kMinThreadBuffer;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+int64_t realtimeNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+const char* baseName(const char* path)
+{
+    const char* slash = std::strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+// 写线程侧的时间戳格式化：同一秒内复用 localtime 结果
+class TimeFormatter {
+public:
+    // 输出 "YYYY-mm-dd HH:MM:SS.uuuuuu"，返回长度
+    int format(int64_t timeNs, char* out, size_t cap)
+    {
+        std::time_t sec = static_cast<std::time_t>(timeNs / 1000000000);
+        if (sec != cachedSec_) {
+            std::tm tmv;
+            localtime_r(&sec, &tmv);
+            std::strftime(cached_, sizeof(cached_), "%Y-%m-%d %H:%M:%S", &tmv);
+            cachedSec_ = sec;
+        }
+        return std::snprintf(out, cap, "%s.%06lld", cached_,
+                             static_cast<long long>((timeNs % 1000000000) / 1000));
+    }
+
+private:
+    std::time_t cachedSec_ = -1;
+    char cached_[32] = {};
+};
+
+size_t formatPrefix(TimeFormatter& tf, char* out, int64_t timeNs, LogLevel level, uint64_t tid,
+                    const char* file, int line, const char* func)
+{
+    char ts[48];
+    tf.format(timeNs, ts, sizeof(ts));
+    int n = std::snprintf(out, kPrefixMax, "[%s][%s][tid:%llu][%s:%d %s] ", ts, LogM::levelToStr(level),
+                          static_cast<unsigned long long>(tid), baseName(file), line, func);
+    if (n < 0) return 0;
+    return std::min(static_cast<size_t>(n), kPrefixMax - 1);
+}
+
+char kNewline[] = "\n";
+
+// 写线程停止后延迟记录的暂存区
+thread_local std::vector<char> t_scratch;
+
+struct DecodedArg {
+    uint8_t tag = 0;
+    int64_t i = 0;
+    uint64_t u = 0;
+    double d = 0;
+    const char* str = nullptr;
+    uint32_t len = 0;
+};
+
+class ArgReader {
+public:
+    ArgReader(const char* p, size_t len) : p_(p), end_(p + len) {}
+
+    bool next(DecodedArg& a)
+    {
+        if (p_ >= end_) return false;
+        a.tag = static_cast<uint8_t>(*p_++);
+        switch (a.tag) {
+        case logm::kArgInt:
+            std::memcpy(&a.i, p_, 8);
+            a.u = static_cast<uint64_t>(a.i);
+            a.d = static_cast<double>(a.i);
+            p_ += 8;
+            return true;
+        case logm::kArgUint:
+        case logm::kArgPointer:
+            std::memcpy(&a.u, p_, 8);
+            a.i = static_cast<int64_t>(a.u);
+            a.d = static_cast<double>(a.u);
+            p_ += 8;
+            return true;
+        case logm::kArgDouble:
+            std::memcpy(&a.d, p_, 8);
+            a.i = static_cast<int64_t>(a.d);
+            a.u = static_cast<uint64_t>(a.i);
+            p_ += 8;
+            return true;
+        case logm::kArgString:
+            std::memcpy(&a.len, p_, 4);
+            a.str = p_ + 4;
+            p_ += 4 + a.len;
+            return true;
+        default:
+            p_ = end_;
+            return false;
+        }
+    }
+
+private:
+    const char* p_;
+    const char* end_;
+};
+
+} // namespace
+
+// -------------------- 延迟格式化 --------------------
+
+size_t logm::formatDeferred(const char* fmt, const char* args, size_t argsLen, char* out, size_t cap)
+{
+    static const char kTruncated[] = "...(truncated)";
+    if (cap == 0) return 0;
+    ArgReader reader(args, argsLen);
+    size_t pos = 0;
+    bool truncated = false;
+    auto append = [&](const char* s, size_t n) {
+        if (pos + n >= cap) {
+            n = cap - 1 - pos;
+            truncated = true;
+        }
+        std::memcpy(out + pos, s, n);
+        pos += n;
+    };
+
+    const char* f = fmt;
+    while (*f && !truncated) {
+        const char* pct = std::strchr(f, '%');
+        if (!pct) {
+            append(f, std::strlen(f));
+            break;
+        }
+        append(f, static_cast<size_t>(pct - f));
+        f = pct + 1;
+        if (*f == '%') {
+            append("%", 1);
+            ++f;
+            continue;
+        }
+
+        logm::FormatSpec spec;
+        f = logm::parseSpec(f, spec);
+        if (!spec.conv) break;
+        DecodedArg a;
+        if (spec.widthStar && reader.next(a)) spec.width = static_cast<int>(a.i);
+        if (spec.precisionStar && reader.next(a)) spec.precision = static_cast<int>(a.i);
+        if (!reader.next(a)) {
+            append("<missing>", 9);
+            continue;
+        }
+
+        // 重建单个转换说明，长度修饰按解码出的类型补齐
+        char one[48];
+        size_t k = 0;
+        one[k++] = '%';
+        for (size_t i = 0; i < spec.flagCount; ++i) one[k++] = spec.flags[i];
+        if (spec.width < 0 && spec.widthStar) {
+            one[k++] = '-';
+            spec.width = -spec.width;
+        }
+        if (spec.width >= 0) k += std::snprintf(one + k, sizeof(one) - k, "%d", spec.width);
+        bool isString = spec.conv == 's';
+        if (spec.precision >= 0 && !isString) k += std::snprintf(one + k, sizeof(one) - k, ".%d", spec.precision);
+
+        char* dst = out + pos;
+        size_t room = cap - pos;
+        int n = 0;
+        switch (spec.conv) {
+        case 'd': case 'i':
+            std::snprintf(one + k, sizeof(one) - k, "ll%c", spec.conv);
+            n = std::snprintf(dst, room, one, static_cast<long long>(a.i));
+            break;
+        case 'u': case 'o': case 'x': case 'X':
+            std::snprintf(one + k, sizeof(one) - k, "ll%c", spec.conv);
+            n = std::snprintf(dst, room, one, static_cast<unsigned long long>(a.u));
+            break;
+        case 'c':
+            std::snprintf(one + k, sizeof(one) - k, "c");
+            n = std::snprintf(dst, room, one, static_cast<int>(a.i));
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            std::snprintf(one + k, sizeof(one) - k, "%c", spec.conv);
+            n = std::snprintf(dst, room, one, a.d);
+            break;
+        case 'p':
+            std::snprintf(one + k, sizeof(one) - k, "p");
+            n = std::snprintf(dst, room, one, reinterpret_cast<void*>(static_cast<uintptr_t>(a.u)));
+            break;
+        case 's':
+            if (a.tag != logm::kArgString) {
+                append("<?>", 3);
+                continue;
+            } else {
+                int len = static_cast<int>(a.len);
+                if (spec.precision >= 0 && spec.precision < len) len = spec.precision;
+                std::snprintf(one + k, sizeof(one) - k, ".*s");
+                n = std::snprintf(dst, room, one, len, a.str);
+            }
+            break;
+        default:
+            append("<?>", 3);
+            continue;
+        }
+        if (n < 0) continue;
+        if (static_cast<size_t>(n) >= room) {
+            pos = cap - 1;
+            truncated = true;
+        } else {
+            pos += static_cast<size_t>(n);
+        }
+    }
+
+    if (truncated && cap > sizeof(kTruncated)) {
+        pos = cap - sizeof(kTruncated);
+        std::memcpy(out + pos, kTruncated, sizeof(kTruncated) - 1);
+        pos += sizeof(kTruncated) - 1;
+    }
+    out[pos] = '\0';
+    return pos;
+}
+
+struct LogM::ThreadRing {
+    explicit ThreadRing(size_t capacity)
+        : buf(new char[capacity]), cap(capacity), mask(capacity - 1) {}
+
+    std::unique_ptr<char[]> buf;
+    size_t cap;
+    size_t mask;
+    uint64_t tid = 0;
+    alignas(64) std::atomic<uint64_t> head{0}; // 生产者写入位置（单调递增）
+    alignas(64) std::atomic<uint64_t> tail{0}; // 写线程已落盘位置
+    std::atomic<bool> retired{false};          // 所属线程已退出
+};
+
+// 线程退出时标记缓冲区，由写线程排空后释放
+struct LogM::RingHandle {
+    ThreadRing* ring = nullptr;
+    ~RingHandle()
+    {
+        if (ring) ring->retired.store(true, std::memory_order_release);
+    }
+};
+
+LogM& LogM::getInstance()
+{
+    // 有意不析构：其他静态对象析构时仍可能写日志；退出时由 atexit 停止写线程并排空
+    static LogM* inst = new LogM();
+    return *inst;
+}
+
+LogM::LogM()
+    : currentLevel(DEBUG),
+      logFilePath("./log/app.log"),
+      maxFileSize(kDefaultMaxFileSize),
+      fileStartTime(std::time(nullptr)),
+      fileSize(0),
+      fd(-1),
+      overflowPolicy(LogOverflowPolicy::Block),
+      threadBufferSize(kDefaultThreadBuffer),
+      dropped(0),
+      flushRequested(0),
+      flushCompleted(0),
+      wakePending(false),
+      running(true)
+{
+    writer = std::thread(&LogM::writerLoop, this);
+    std::atexit(&LogM::stopAtExit);
+}
+
+LogM::~LogM()
+{
+    stopWriter();
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+const char* LogM::levelToStr(LogLevel level)
+{
+    switch (level) {
+    case DEBUG: return "DEBUG";
+    case INFO:  return "INFO";
+    case WARN:  return "WARN";
+    case ERROR: return "ERROR";
+    }
+    return "UNKNOWN";
+}
+
+void LogM::setLogFile(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    logFilePath = path;
+    openFileLocked();
+}
+
+void LogM::setThreadBufferSize(size_t bytes)
+{
+    threadBufferSize.store(roundUpPow2(bytes), std::memory_order_relaxed);
+}
+
+// -------------------- 调用线程侧 --------------------
+
+LogM::ThreadRing* LogM::localRing()
+{
+    static thread_local RingHandle handle;
+    if (handle.ring) return handle.ring;
+
+    auto ring = std::make_unique<ThreadRing>(threadBufferSize.load(std::memory_order_relaxed));
+    ring->tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+    handle.ring = ring.get();
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    rings.push_back(std::move(ring));
+    return handle.ring;
+}
+
+char* LogM::reserve(ThreadRing& ring, size_t bytes, uint64_t& newHead)
+{
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    while (true) {
+        uint64_t tail = ring.tail.load(std::memory_order_acquire);
+        size_t off = head & ring.mask;
+        size_t contiguous = ring.cap - off;
+        size_t pad = contiguous < bytes ? contiguous : 0;
+        if (ring.cap - (head - tail) >= bytes + pad) {
+            if (pad) {
+                auto* hdr = reinterpret_cast<RecordHeader*>(ring.buf.get() + off);
+                hdr->size = static_cast<uint32_t>(pad);
+                hdr->kind = kPadding;
+                head += pad;
+                off = 0;
+            }
+            newHead = head + bytes;
+            return ring.buf.get() + off;
+        }
+        if (overflowPolicy.load(std::memory_order_relaxed) == LogOverflowPolicy::Drop ||
+            !running.load(std::memory_order_acquire)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        wakeWriter();
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+
+void LogM::log(LogLevel level,
+               const char* file,
+               int line,
+               const char* func,
+               const char* message)
+{
+    if (!running.load(std::memory_order_acquire)) {
+        logSync(level, file, line, func, message);
+        return;
+    }
+
+    ThreadRing* ring = localRing();
+    size_t len = std::strlen(message);
+    size_t maxLen = ring->cap / 4 - sizeof(RecordHeader);
+    if (len > maxLen) len = maxLen;
+    size_t bytes = alignRecord(sizeof(RecordHeader) + len);
+
+    uint64_t newHead;
+    char* p = reserve(*ring, bytes, newHead);
+    if (!p) return;
+
+    auto* hdr = new (p) RecordHeader;
+    hdr->size = static_cast<uint32_t>(bytes);
+    hdr->kind = kText;
+    hdr->level = static_cast<uint8_t>(level);
+    hdr->reserved = 0;
+    hdr->msgLen = static_cast<uint32_t>(len);
+    hdr->line = line;
+    hdr->timeNs = realtimeNs();
+    hdr->file = file;
+    hdr->func = func;
+    std::memcpy(p + sizeof(RecordHeader), message, len);
+    publish(*ring, newHead);
+}
+
+char* LogM::beginDeferred(LogLevel level, const char* file, int line, const char* func,
+                          const char* fmt, size_t payload, ThreadRing*& ring, uint64_t& newHead)
+{
+    size_t bytes = alignRecord(sizeof(RecordHeader) + payload);
+    char* p;
+    if (running.load(std::memory_order_acquire)) {
+        ring = localRing();
+        p = reserve(*ring, bytes, newHead);
+        if (!p) return nullptr;
+    } else {
+        // 写线程已停止（进程退出阶段）：编码到线程局部暂存区，提交时同步格式化写出
+        t_scratch.resize(bytes);
+        ring = nullptr;
+        p = t_scratch.data();
+    }
+
+    auto* hdr = new (p) RecordHeader;
+    hdr->size = static_cast<uint32_t>(bytes);
+    hdr->kind = kDeferred;
+    hdr->level = static_cast<uint8_t>(level);
+    hdr->reserved = 0;
+    hdr->msgLen = static_cast<uint32_t>(payload);
+    hdr->line = line;
+    hdr->timeNs = realtimeNs();
+    hdr->file = file;
+    hdr->func = func;
+    hdr->fmt = fmt;
+    return p + sizeof(RecordHeader);
+}
+
+void LogM::commitDeferred(ThreadRing* ring, uint64_t newHead)
+{
+    if (!ring) {
+        auto* hdr = reinterpret_cast<const RecordHeader*>(t_scratch.data());
+        char msg[kMessageMax + 1];
+        logm::formatDeferred(hdr->fmt, reinterpret_cast<const char*>(hdr + 1), hdr->msgLen, msg, sizeof(msg));
+        logSync(static_cast<LogLevel>(hdr->level), hdr->file, hdr->line, hdr->func, msg);
+        return;
+    }
+    publish(*ring, newHead);
+}
+
+void LogM::publish(ThreadRing& ring, uint64_t newHead)
+{
+    ring.head.store(newHead, std::memory_order_release);
+    // 发布后再确认一次：预留时写线程还在，但 stopWriter 可能已开始，它的最终排空未必看到这条记录，
+    // 由本线程补一次。与 stopWriter 中的栅栏配对，保证记录要么被写线程、要么被本线程写出
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!running.load(std::memory_order_relaxed)) {
+        std::vector<ThreadRing*> snapshot;
+        drainOnce(snapshot);
+        return;
+    }
+    // 过半时提前唤醒写线程，平时由写线程定时拉取，调用线程不做系统调用
+    if (newHead - ring.tail.load(std::memory_order_relaxed) > ring.cap / 2) {
+        wakeWriter();
+    }
+}
+
+void LogM::wakeWriter()
+{
+    if (!wakePending.exchange(true, std::memory_order_acq_rel)) {
+        wakeCond.notify_one();
+    }
+}
+
+void LogM::flush()
+{
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    if (!running.load(std::memory_order_acquire)) return;
+    uint64_t gen = ++flushRequested;
+    wakeCond.notify_one();
+    flushCond.wait(lock, [&]() {
+        return flushCompleted >= gen || !running.load(std::memory_order_acquire);
+    });
+}
+
+// -------------------- 写线程侧 --------------------
+
+void LogM::writerLoop()
+{
+    std::vector<ThreadRing*> snapshot;
+    while (true) {
+        uint64_t flushGen;
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCond.wait_for(lock, kWriterInterval, [this]() {
+                return !running.load(std::memory_order_acquire) || flushRequested != flushCompleted ||
+                       wakePending.load(std::memory_order_acquire);
+            });
+            wakePending.store(false, std::memory_order_release);
+            flushGen = flushRequested;
+            stopping = !running.load(std::memory_order_acquire);
+        }
+
+        drainOnce(snapshot);
+
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            flushCompleted = flushGen;
+        }
+        flushCond.notify_all();
+
+        if (stopping) {
+            // 停止前排空仍在途的记录
+            while (drainOnce(snapshot) > 0) {}
+            break;
+        }
+    }
+}
+
+size_t LogM::drainOnce(std::vector<ThreadRing*>& snapshot)
+{
+    struct Pending {
+        const RecordHeader* hdr;
+        uint64_t tid;
+        size_t order; // 同一时间戳按收集顺序，保证同线程记录不乱序
+    };
+    static thread_local std::vector<Pending> pending;
+    static thread_local std::vector<std::pair<ThreadRing*, uint64_t>> advances;
+    static thread_local std::vector<char> staging(static_cast<size_t>(kMaxIov) * kSlotSize);
+    static thread_local TimeFormatter timeFormatter;
+    static uint64_t reportedDropped = 0;
+
+    std::lock_guard<std::mutex> drainLock(drainMutex);
+    snapshot.clear();
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        // 释放已退出且已排空的线程缓冲区
+        rings.erase(std::remove_if(rings.begin(), rings.end(), [](const std::unique_ptr<ThreadRing>& r) {
+                        return r->retired.load(std::memory_order_acquire) &&
+                               r->tail.load(std::memory_order_relaxed) ==
+                                   r->head.load(std::memory_order_acquire);
+                    }),
+                    rings.end());
+        for (auto& r : rings) snapshot.push_back(r.get());
+    }
+
+    pending.clear();
+    advances.clear();
+    for (ThreadRing* ring : snapshot) {
+        uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        if (tail == head) continue;
+        for (uint64_t pos = tail; pos < head;) {
+            auto* hdr = reinterpret_cast<const RecordHeader*>(ring->buf.get() + (pos & ring->mask));
+            if (hdr->kind != kPadding) pending.push_back({hdr, ring->tid, pending.size()});
+            pos += hdr->size;
+        }
+        advances.emplace_back(ring, head);
+    }
+
+    // 各线程记录按时间戳归并，保持文件内大体有序
+    std::sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) {
+        return a.hdr->timeNs != b.hdr->timeNs ? a.hdr->timeNs < b.hdr->timeNs : a.order < b.order;
+    });
+
+    uint64_t droppedNow = dropped.load(std::memory_order_relaxed);
+    char dropLine[kPrefixMax + 64];
+    size_t dropLen = 0;
+    if (droppedNow != reportedDropped) {
+        size_t n = formatPrefix(timeFormatter, dropLine, realtimeNs(), WARN, 0, "LogM", 0, "writer");
+        int m = std::snprintf(dropLine + n, sizeof(dropLine) - n, "dropped %llu log records (buffer full)\n",
+                              static_cast<unsigned long long>(droppedNow - reportedDropped));
+        dropLen = n + static_cast<size_t>(std::max(m, 0));
+        reportedDropped = droppedNow;
+    }
+
+    iovec iov[kMaxIov + 1];
+    std::lock_guard<std::mutex> lock(fileMutex);
+    size_t i = 0;
+    while (i < pending.size() || dropLen) {
+        int count = 0;
+        size_t bytes = 0;
+        char* slot = staging.data();
+        while (i < pending.size() && count + 3 <= kMaxIov) {
+            const RecordHeader* hdr = pending[i].hdr;
+            const char* body = reinterpret_cast<const char*>(hdr + 1);
+            size_t n = formatPrefix(timeFormatter, slot, hdr->timeNs, static_cast<LogLevel>(hdr->level),
+                                    pending[i].tid, hdr->file, hdr->line, hdr->func);
+            if (hdr->kind == kDeferred) {
+                // 前缀与消息格式化到同一槽位，一段 iovec
+                n += logm::formatDeferred(hdr->fmt, body, hdr->msgLen, slot + n, kMessageMax + 1);
+                slot[n++] = '\n';
+                iov[count++] = {slot, n};
+                bytes += n;
+            } else {
+                // 已格式化的消息直接引用环形缓冲区
+                iov[count++] = {slot, n};
+                iov[count++] = {const_cast<char*>(body), hdr->msgLen};
+                iov[count++] = {kNewline, 1};
+                bytes += n + hdr->msgLen + 1;
+            }
+            slot += kSlotSize;
+            ++i;
+        }
+        if (i == pending.size() && dropLen) {
+            iov[count++] = {dropLine, dropLen};
+            bytes += dropLen;
+            dropLen = 0;
+        }
+        writeLocked(iov, count, bytes);
+    }
+
+    // 落盘后才归还缓冲区空间（iovec 直接指向环形缓冲区中的正文）
+    for (auto& adv : advances) {
+        adv.first->tail.store(adv.second, std::memory_order_release);
+    }
+    return pending.size();
+}
+
+void LogM::stopWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        if (!running.load(std::memory_order_acquire)) return;
+        running.store(false, std::memory_order_release);
+    }
+    wakeCond.notify_all();
+    flushCond.notify_all();
+    if (writer.joinable()) writer.join();
+    // 与 publish 中的栅栏配对：写线程最终排空之后才发布的记录，要么在这里被排空，
+    // 要么其发布线程看到 running 为 false 自行排空
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::vector<ThreadRing*> snapshot;
+    drainOnce(snapshot);
+}
+
+void LogM::stopAtExit()
+{
+    getInstance().stopWriter();
+}
+
+// -------------------- 文件输出 --------------------
+
+bool LogM::openFileLocked()
+{
+    std::filesystem::path path(logFilePath);
+    if (path.has_parent_path()) {
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+        if (ec) {
+            std::fprintf(stderr, "[LogM] create directories failed: %s\n", ec.message().c_str());
+        }
+    }
+    fd = ::open(logFilePath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::fprintf(stderr, "[LogM] open %s failed: %s\n", logFilePath.c_str(), std::strerror(errno));
+        return false;
+    }
+    struct stat st;
+    fileSize = (::fstat(fd, &st) == 0) ? static_cast<size_t>(st.st_size) : 0;
+    fileStartTime = std::time(nullptr);
+    return true;
+}
+
+void LogM::writeLocked(const iovec* iov, int count, size_t bytes)
+{
+    if (fd < 0 && !openFileLocked()) {
+        ::writev(STDERR_FILENO, iov, count);
+        return;
+    }
+
+    // 处理部分写：跳过已写完的段，继续写剩余部分
+    iovec local[kMaxIov + 1];
+    std::copy(iov, iov + count, local);
+    iovec* cur = local;
+    int left = count;
+    size_t remaining = bytes;
+    while (left > 0 && remaining > 0) {
+        ssize_t n = ::writev(fd, cur, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::fprintf(stderr, "[LogM] write failed: %s\n", std::strerror(errno));
+            break;
+        }
+        remaining -= static_cast<size_t>(n);
+        size_t done = static_cast<size_t>(n);
+        while (left > 0 && done >= cur->iov_len) {
+            done -= cur->iov_len;
+            ++cur;
+            --left;
+        }
+        if (left > 0) {
+            cur->iov_base = static_cast<char*>(cur->iov_base) + done;
+            cur->iov_len -= done;
+        }
+    }
+    fileSize += bytes - remaining;
+    rotateIfNeeded(std::time(nullptr));
+}
+
+void LogM::rotateIfNeeded(std::time_t now_c)
+{
+    if (fileSize < maxFileSize.load(std::memory_order_relaxed)) return;
+
+    auto stamp = [](std::time_t t) {
+        char buf[32];
+        std::tm tmv;
+        localtime_r(&t, &tmv);
+        std::strftime(buf, sizeof(buf), "%Y%m%d-%H%M%S", &tmv);
+        return std::string(buf);
+    };
+
+    ::close(fd);
+    fd = -1;
+    std::filesystem::path path(logFilePath);
+    std::filesystem::path rotated = path.parent_path() /
+        (path.stem().string() + "_" + stamp(fileStartTime) + "_" + stamp(now_c) + path.extension().string());
+    // 同一秒内多次轮转时追加序号，避免覆盖
+    for (int seq = 1; std::filesystem::exists(rotated); ++seq) {
+        rotated = path.parent_path() / (path.stem().string() + "_" + stamp(fileStartTime) + "_" +
+                                        stamp(now_c) + "." + std::to_string(seq) + path.extension().string());
+    }
+    if (std::rename(logFilePath.c_str(), rotated.c_str()) != 0) {
+        std::fprintf(stderr, "[LogM] rotate rename failed: %s\n", std::strerror(errno));
+    }
+    openFileLocked();
+}
+
+void LogM::logSync(LogLevel level, const char* file, int line, const char* func, const char* message)
+{
+    static TimeFormatter timeFormatter;
+    char prefix[kPrefixMax];
+    std::lock_guard<std::mutex> lock(fileMutex);
+    size_t n = formatPrefix(timeFormatter, prefix, realtimeNs(), level,
+                            std::hash<std::thread::id>()(std::this_thread::get_id()), file, line, func);
+    size_t len = std::strlen(message);
+    iovec iov[3] = {{prefix, n}, {const_cast<char*>(message), len}, {kNewline, 1}};
+    writeLocked(iov, 3, n + len + 1);
+}
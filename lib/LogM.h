@@ -3,11 +3,18 @@
 
 #include <string>
 #include <cstdio>
+#include <cstdint>
 #include <mutex>
 #include <atomic>
 #include <thread>
 #include <ctime>
 #include <cstring>
+#include <vector>
+#include <memory>
+#include <condition_variable>
+#include <type_traits>
+
+struct iovec;
 
 // 日志级别
 enum LogLevel {
@@ -17,17 +24,327 @@ enum LogLevel {
     ERROR = 3
 };
 
+// 线程环形缓冲区写满时的处理策略
+enum class LogOverflowPolicy {
+    Block, // 等待写线程腾出空间（默认，不丢日志）
+    Drop   // 直接丢弃本条并计数，调用线程不等待
+};
+
+// -----------------------------------------------------------------------------
+// 延迟格式化：调用线程只记录格式串指针与原始参数（二进制），由写线程格式化
+// -----------------------------------------------------------------------------
+namespace logm {
+
+constexpr size_t kMaxDeferredArgs = 16;
+constexpr size_t kMaxDeferredString = 512; // 单个字符串参数最多保留的字节数
+
+// 参数编码：[tag][值]，整数/浮点/指针 8 字节，字符串为 [uint32 长度][字节]
+enum ArgTag : uint8_t {
+    kArgInt = 1,
+    kArgUint = 2,
+    kArgDouble = 3,
+    kArgString = 4,
+    kArgPointer = 5,
+};
+
+// printf 转换说明：%[flags][width][.precision][length]conv
+struct FormatSpec {
+    char flags[8] = {};
+    size_t flagCount = 0;
+    bool widthStar = false;
+    int width = -1;
+    bool precisionStar = false;
+    int precision = -1;
+    char conv = 0;
+};
+
+constexpr bool isOneOf(char c, const char* set)
+{
+    for (; *set; ++set) {
+        if (*set == c) return true;
+    }
+    return false;
+}
+
+// f 指向 '%' 之后；返回转换字符之后的位置，格式串意外结束时 spec.conv 为 0
+constexpr const char* parseSpec(const char* f, FormatSpec& spec)
+{
+    while (*f && isOneOf(*f, "-+ #0'")) {
+        if (spec.flagCount < sizeof(spec.flags)) spec.flags[spec.flagCount++] = *f;
+        ++f;
+    }
+    if (*f == '*') {
+        spec.widthStar = true;
+        ++f;
+    } else {
+        while (*f >= '0' && *f <= '9') spec.width = (spec.width < 0 ? 0 : spec.width * 10) + (*f++ - '0');
+    }
+    if (*f == '.') {
+        ++f;
+        spec.precision = 0;
+        if (*f == '*') {
+            spec.precisionStar = true;
+            ++f;
+        } else {
+            while (*f >= '0' && *f <= '9') spec.precision = spec.precision * 10 + (*f++ - '0');
+        }
+    }
+    while (*f && isOneOf(*f, "hlLqjzt")) ++f; // 长度修饰由解码出的参数类型决定
+    if (*f) spec.conv = *f++;
+    return f;
+}
+
+// 调用点级元数据：编译期解析格式串
+struct FormatInfo {
+    uint32_t boundedStrings = 0; // 第 i 位：第 i 个参数是 "%.*s" 的字符串，长度以前一个参数为上限
+
+    static constexpr FormatInfo parse(const char* fmt)
+    {
+        FormatInfo info;
+        size_t arg = 0;
+        for (const char* f = fmt; *f;) {
+            if (*f++ != '%') continue;
+            if (*f == '%') {
+                ++f;
+                continue;
+            }
+            FormatSpec spec;
+            f = parseSpec(f, spec);
+            if (!spec.conv) break;
+            if (spec.widthStar) ++arg;
+            if (spec.precisionStar) ++arg;
+            if (spec.conv == 's' && spec.precisionStar && arg < 32) info.boundedStrings |= 1u << arg;
+            ++arg;
+        }
+        return info;
+    }
+};
+
+// 写线程侧：按 fmt 解码参数并格式化到 out，返回写入长度（不含 '\0'，超长时截断）
+size_t formatDeferred(const char* fmt, const char* args, size_t argsLen, char* out, size_t cap);
+
+struct ArgEncoder {
+    const FormatInfo& info;
+    size_t index = 0;
+    long long prevInt = -1;
+    uint32_t strLen[kMaxDeferredArgs] = {};
+};
+
+template <typename T> struct DependentFalse : std::false_type {};
+template <typename T, bool = std::is_enum_v<T>> struct IntegerOf { using type = T; };
+template <typename T> struct IntegerOf<T, true> { using type = std::underlying_type_t<T>; };
+
+template <typename T>
+constexpr bool kIsCString = std::is_same_v<T, const char*> || std::is_same_v<T, char*>;
+
+// char 数组（含字符串字面量）：按 %s 处理，但地址不可能为空，也不会读出数组之外
+template <typename T>
+constexpr bool kIsCharArray = std::is_array_v<std::remove_reference_t<T>> &&
+    std::is_same_v<std::remove_cv_t<std::remove_extent_t<std::remove_reference_t<T>>>, char>;
+
+inline uint32_t boundedStrlen(const char* s, long long bound)
+{
+    size_t cap = kMaxDeferredString;
+    if (bound >= 0 && static_cast<size_t>(bound) < cap) cap = static_cast<size_t>(bound);
+    return static_cast<uint32_t>(strnlen(s, cap));
+}
+
+template <typename T>
+inline size_t measureArg(ArgEncoder& enc, const T& value)
+{
+    using D = std::decay_t<T>;
+    size_t i = enc.index++;
+    if constexpr (kIsCharArray<T>) {
+        constexpr long long extent = static_cast<long long>(std::extent_v<std::remove_reference_t<T>>);
+        bool bounded = ((enc.info.boundedStrings >> i) & 1u) && enc.prevInt >= 0 && enc.prevInt < extent;
+        enc.strLen[i] = boundedStrlen(value, bounded ? enc.prevInt : extent);
+        return 1 + 4 + enc.strLen[i];
+    } else if constexpr (std::is_integral_v<D> || std::is_enum_v<D>) {
+        enc.prevInt = static_cast<long long>(value);
+        return 1 + 8;
+    } else if constexpr (std::is_floating_point_v<D>) {
+        return 1 + 8;
+    } else if constexpr (kIsCString<D>) {
+        const char* s = value;
+        bool bounded = (enc.info.boundedStrings >> i) & 1u;
+        enc.strLen[i] = s ? boundedStrlen(s, bounded ? enc.prevInt : -1) : 6; // "(null)"
+        return 1 + 4 + enc.strLen[i];
+    } else if constexpr (std::is_pointer_v<D> || std::is_null_pointer_v<D>) {
+        return 1 + 8;
+    } else {
+        static_assert(DependentFalse<D>::value, "unsupported LOG_* argument type");
+        return 0;
+    }
+}
+
+template <typename T>
+inline char* writeArg(ArgEncoder& enc, char* p, const T& value)
+{
+    using D = std::decay_t<T>;
+    size_t i = enc.index++;
+    if constexpr (kIsCharArray<T>) {
+        uint32_t len = enc.strLen[i];
+        *p++ = static_cast<char>(kArgString);
+        std::memcpy(p, &len, 4);
+        std::memcpy(p + 4, value, len);
+        return p + 4 + len;
+    } else if constexpr (std::is_integral_v<D> || std::is_enum_v<D>) {
+        using I = typename IntegerOf<D>::type;
+        if constexpr (std::is_unsigned_v<I> && !std::is_same_v<I, bool>) {
+            uint64_t v = static_cast<uint64_t>(value);
+            *p++ = static_cast<char>(kArgUint);
+            std::memcpy(p, &v, 8);
+        } else {
+            int64_t v = static_cast<int64_t>(value);
+            *p++ = static_cast<char>(kArgInt);
+            std::memcpy(p, &v, 8);
+        }
+        return p + 8;
+    } else if constexpr (std::is_floating_point_v<D>) {
+        double v = static_cast<double>(value);
+        *p++ = static_cast<char>(kArgDouble);
+        std::memcpy(p, &v, 8);
+        return p + 8;
+    } else if constexpr (kIsCString<D>) {
+        const char* s = value ? value : "(null)";
+        uint32_t len = enc.strLen[i];
+        *p++ = static_cast<char>(kArgString);
+        std::memcpy(p, &len, 4);
+        std::memcpy(p + 4, s, len);
+        return p + 4 + len;
+    } else {
+        uint64_t v = reinterpret_cast<uintptr_t>(static_cast<const void*>(value));
+        *p++ = static_cast<char>(kArgPointer);
+        std::memcpy(p, &v, 8);
+        return p + 8;
+    }
+}
+
+// -------------------- 编译期格式检查 --------------------
+// LOG_* 宏对每个调用点做 static_assert，转换说明与参数个数/类型不符时编译失败
+
+enum class ArgKind : uint8_t { None, Integer, Floating, CString, Pointer, Other };
+
+// 与 measureArg/writeArg 的分支一一对应：char 数组单独归为字符串，其余按退化后的类型判断
+template <typename T>
+constexpr ArgKind argKind()
+{
+    using D = std::decay_t<T>;
+    if constexpr (kIsCharArray<T>) return ArgKind::CString;
+    else if constexpr (std::is_integral_v<D> || std::is_enum_v<D>) return ArgKind::Integer;
+    else if constexpr (std::is_floating_point_v<D>) return ArgKind::Floating;
+    else if constexpr (kIsCString<D>) return ArgKind::CString;
+    else if constexpr (std::is_pointer_v<D> || std::is_null_pointer_v<D>) return ArgKind::Pointer;
+    else return ArgKind::Other;
+}
+
+enum class FormatCheck : uint8_t {
+    Ok,
+    BadSpec,       // 转换字符缺失或不受支持（如 %n）
+    TooFewArgs,
+    TooManyArgs,
+    TypeMismatch,  // 如 %d 配 double、%s 配 int
+    UnsupportedArg // 如 std::string（需 .c_str()）
+};
+
+template <typename... Args> struct ArgList {};
+
+// 仅用于 decltype 推导参数类型，不会被求值
+template <typename... Args>
+constexpr ArgList<Args...> argList(const Args&...) { return {}; }
+
+constexpr bool kindMatches(char conv, ArgKind kind)
+{
+    switch (conv) {
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+        return kind == ArgKind::Integer;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        return kind == ArgKind::Floating;
+    case 's':
+        return kind == ArgKind::CString;
+    case 'p':
+        return kind == ArgKind::Pointer;
+    default:
+        return false;
+    }
+}
+
+template <typename... Args>
+constexpr FormatCheck checkFormat(const char* fmt, ArgList<Args...>)
+{
+    constexpr ArgKind kinds[] = {argKind<Args>()..., ArgKind::None};
+    constexpr size_t count = sizeof...(Args);
+    for (size_t i = 0; i < count; ++i) {
+        if (kinds[i] == ArgKind::Other) return FormatCheck::UnsupportedArg;
+    }
+
+    size_t arg = 0;
+    for (const char* f = fmt; *f;) {
+        if (*f++ != '%') continue;
+        if (*f == '%') {
+            ++f;
+            continue;
+        }
+        FormatSpec spec;
+        f = parseSpec(f, spec);
+        if (!spec.conv || !isOneOf(spec.conv, "diuoxXcfFeEgGaAsp")) return FormatCheck::BadSpec;
+        if (spec.widthStar) {
+            if (arg >= count) return FormatCheck::TooFewArgs;
+            if (kinds[arg++] != ArgKind::Integer) return FormatCheck::TypeMismatch;
+        }
+        if (spec.precisionStar) {
+            if (arg >= count) return FormatCheck::TooFewArgs;
+            if (kinds[arg++] != ArgKind::Integer) return FormatCheck::TypeMismatch;
+        }
+        if (arg >= count) return FormatCheck::TooFewArgs;
+        if (!kindMatches(spec.conv, kinds[arg++])) return FormatCheck::TypeMismatch;
+    }
+    return arg < count ? FormatCheck::TooManyArgs : FormatCheck::Ok;
+}
+
+// 字面量与 char 缓冲区是 %s 的合法参数，其他元素类型的数组按指针处理
+static_assert(checkFormat("%s %s %.*s", ArgList<char[5], const char[16], int, char[4]>{}) == FormatCheck::Ok,
+              "char arrays must be accepted for %s");
+static_assert(checkFormat("%d", ArgList<char[5]>{}) == FormatCheck::TypeMismatch,
+              "char arrays must not be accepted for %d");
+static_assert(checkFormat("%s", ArgList<int[4]>{}) == FormatCheck::TypeMismatch &&
+                  checkFormat("%p", ArgList<int[4]>{}) == FormatCheck::Ok,
+              "non-char arrays are pointers");
+
+} // namespace logm
+
+// 异步日志：每个线程一个单生产者/单消费者环形缓冲区，调用线程只做一次拷贝；
+// 后台写线程按时间戳归并各线程的记录，用 writev 批量落盘并负责轮转。
 class LogM {
 public:
     static LogM& getInstance();
 
-    // 已格式化消息入口（线程安全）
+    // 已格式化消息入口（线程安全，不持锁、不做文件 IO）
     void log(LogLevel level,
              const char* file,
              int line,
              const char* func,
              const char* message);
 
+    // 延迟格式化入口（LOG_* 宏默认走这里）：只拷贝格式串指针与参数，
+    // 格式化在写线程进行，因此 fmt 必须是字符串字面量
+    template <typename... Args>
+    void logDeferred(LogLevel level, const char* file, int line, const char* func,
+                     const char* fmt, const logm::FormatInfo& info, const Args&... args)
+    {
+        static_assert(sizeof...(Args) <= logm::kMaxDeferredArgs, "too many LOG_* arguments");
+        logm::ArgEncoder enc{info};
+        size_t payload = (size_t{0} + ... + logm::measureArg(enc, args));
+        ThreadRing* ring = nullptr;
+        uint64_t newHead = 0;
+        char* p = beginDeferred(level, file, line, func, fmt, payload, ring, newHead);
+        if (!p) return;
+        enc.index = 0;
+        ((p = logm::writeArg(enc, p, args)), ...);
+        (void)enc;
+        commitDeferred(ring, newHead);
+    }
+
     // 设置 / 获取当前输出最低级别
     void setLevel(LogLevel level) { currentLevel.store(level, std::memory_order_relaxed); }
     LogLevel getLevel() const { return currentLevel.load(std::memory_order_relaxed); }
@@ -38,57 +355,149 @@ public:
     const std::string& getLogFile() const { return logFilePath; }
 
     // 设置最大文件大小（字节），超过则轮转
-    void setMaxFileSize(size_t bytes) { maxFileSize = bytes; }
+    void setMaxFileSize(size_t bytes) { maxFileSize.store(bytes, std::memory_order_relaxed); }
+
+    // 缓冲区满时的策略
+    void setOverflowPolicy(LogOverflowPolicy policy) { overflowPolicy.store(policy, std::memory_order_relaxed); }
+    // 之后新注册线程的环形缓冲区大小（字节，向上取 2 的幂）
+    void setThreadBufferSize(size_t bytes);
+    // Drop 策略下累计丢弃的记录数
+    uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+    // 阻塞直到调用前已写入缓冲区的记录全部落盘
+    void flush();
 
     static const char* levelToStr(LogLevel level);
 
     ~LogM();
 
 private:
+    struct ThreadRing;
+    struct RingHandle;
+
     LogM();
     LogM(const LogM&) = delete;
     LogM& operator=(const LogM&) = delete;
 
-    // 轮转检查（在持锁状态下调用）
+    ThreadRing* localRing();
+    void wakeWriter();
+    // 预留并填写记录头，返回参数区起始地址；写线程已停止时返回线程局部暂存区（ring 为空）
+    char* beginDeferred(LogLevel level, const char* file, int line, const char* func,
+                        const char* fmt, size_t payload, ThreadRing*& ring, uint64_t& newHead);
+    void commitDeferred(ThreadRing* ring, uint64_t newHead);
+    // 发布已填好的记录（推进 head），必要时唤醒写线程；若写线程已在停止，由本线程补排空
+    void publish(ThreadRing& ring, uint64_t newHead);
+    // 在本线程缓冲区中预留 bytes 字节（已按 8 对齐），满时按策略等待或返回 nullptr
+    char* reserve(ThreadRing& ring, size_t bytes, uint64_t& newHead);
+
+    void writerLoop();
+    // 收集各线程缓冲区中的记录并写出，返回写出的条数；持 drainMutex，同一时刻只有一个消费者
+    size_t drainOnce(std::vector<ThreadRing*>& rings);
+    void stopWriter();
+    static void stopAtExit();
+
+    // 以下在持 fileMutex 状态下调用
+    bool openFileLocked();
+    void writeLocked(const iovec* iov, int count, size_t bytes);
     void rotateIfNeeded(std::time_t now_c);
+    // 写线程停止后的同步路径（进程退出阶段）
+    void logSync(LogLevel level, const char* file, int line, const char* func, const char* message);
 
     std::atomic<LogLevel> currentLevel; // 原子，避免竞态
     std::string logFilePath;
-    std::mutex logMutex; // 保护文件写
+    std::mutex fileMutex; // 保护文件句柄、路径与轮转，仅写线程与配置接口使用
+
+    std::atomic<size_t> maxFileSize; // 触发轮转的大小
+    std::time_t fileStartTime;       // 当前文件开始时间
+    size_t fileSize;
+    int fd;
 
-    size_t maxFileSize;          // 触发轮转的大小
-    std::time_t fileStartTime;   // 当前文件开始时间
+    std::atomic<LogOverflowPolicy> overflowPolicy;
+    std::atomic<size_t> threadBufferSize;
+    std::atomic<uint64_t> dropped;
+
+    // 已注册的线程缓冲区；线程退出后由写线程在排空后释放
+    std::mutex ringsMutex;
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+    // 串行化 drainOnce：平时只有写线程排空，写线程停止前后发布记录的调用线程也会补一次
+    std::mutex drainMutex;
+
+    std::mutex wakeMutex;
+    std::condition_variable wakeCond;   // 唤醒写线程
+    std::condition_variable flushCond;  // 通知 flush 等待者
+    uint64_t flushRequested;
+    uint64_t flushCompleted;
+    std::atomic<bool> wakePending; // 有线程缓冲区过半或已满，写线程应立即排空
+    std::atomic<bool> running;
+    std::thread writer;
 };
 
 // -----------------------------------------------------------------------------
 // 通用宏：避免重复代码；使用 enabled() 而不是访问私有成员
 // -----------------------------------------------------------------------------
+// 编译期最低级别（0=DEBUG … 3=ERROR）：低于它的 LOG_* 整条被 if constexpr 丢弃，
+// 不产生任何代码，但参数与格式串仍参与编译检查。由 CMake 的 WEBSITE_LOG_MIN_LEVEL 设置。
+#ifndef LOGM_MIN_LEVEL
+#define LOGM_MIN_LEVEL 0
+#endif
+
+// 编译期格式检查："" fmt 要求格式串为字面量
+#define LOGM_CHECK_FORMAT(fmt, ...)                                                   \
+    constexpr logm::FormatCheck _check =                                             \
+        logm::checkFormat("" fmt, decltype(logm::argList(__VA_ARGS__)){});            \
+    static_assert(_check != logm::FormatCheck::BadSpec,                              \
+                  "LOG_*: unsupported or incomplete conversion in format string");   \
+    static_assert(_check != logm::FormatCheck::TooFewArgs,                           \
+                  "LOG_*: format string has more conversions than arguments");       \
+    static_assert(_check != logm::FormatCheck::TooManyArgs,                          \
+                  "LOG_*: more arguments than format conversions");                  \
+    static_assert(_check != logm::FormatCheck::TypeMismatch,                         \
+                  "LOG_*: argument type does not match its conversion");             \
+    static_assert(_check != logm::FormatCheck::UnsupportedArg,                       \
+                  "LOG_*: unsupported argument type (pass std::string via .c_str())")
+
+// 默认延迟格式化：记录中只保存格式串指针。
+// 定义 LOGM_IMMEDIATE_FORMAT 时退回调用线程 snprintf 的旧路径。
+#ifndef LOGM_IMMEDIATE_FORMAT
+#define LOG_BASE(level, fmt, ...)                                                     \
+    do {                                                                             \
+        LOGM_CHECK_FORMAT(fmt, ##__VA_ARGS__);                                       \
+        if constexpr ((level) >= LOGM_MIN_LEVEL) {                                   \
+            auto& _lg = LogM::getInstance();                                         \
+            if (_lg.enabled(level)) {                                                \
+                static constexpr logm::FormatInfo _info = logm::FormatInfo::parse(fmt); \
+                _lg.logDeferred(level, __FILE__, __LINE__, __func__, fmt, _info,     \
+                                ##__VA_ARGS__);                                      \
+            }                                                                        \
+        }                                                                            \
+    } while (0)
+#else
 #define LOG_BASE(level, fmt, ...)                                                     \
     do {                                                                             \
-        auto& _lg = LogM::getInstance();                                             \
-        if (_lg.enabled(level)) {                                                    \
-            char _buff[512];                                                         \
-            int _n = std::snprintf(_buff, sizeof(_buff), fmt, ##__VA_ARGS__);        \
-            if (_n < 0) {                                                            \
-                std::snprintf(_buff, sizeof(_buff), "<format error>");             \
-            } else if (_n >= (int)sizeof(_buff)) {                                   \
-                /* 截断标记 */                                                      \
-                const char* suffix = "...(truncated)";                              \
-                size_t keep = sizeof(_buff) - std::strlen(suffix) - 1;               \
-                if (keep > 0) {                                                      \
+        LOGM_CHECK_FORMAT(fmt, ##__VA_ARGS__);                                       \
+        if constexpr ((level) >= LOGM_MIN_LEVEL) {                                   \
+            auto& _lg = LogM::getInstance();                                         \
+            if (_lg.enabled(level)) {                                                \
+                char _buff[512];                                                     \
+                int _n = std::snprintf(_buff, sizeof(_buff), fmt, ##__VA_ARGS__);    \
+                if (_n >= (int)sizeof(_buff)) {                                      \
+                    /* 截断标记 */                                                  \
+                    const char* suffix = "...(truncated)";                          \
+                    size_t keep = sizeof(_buff) - std::strlen(suffix) - 1;           \
                     _buff[keep] = '\0';                                             \
                     std::strcat(_buff, suffix);                                      \
-                } else {                                                             \
-                    std::snprintf(_buff, sizeof(_buff), "%s", suffix);             \
+                } else if (_n < 0) {                                                 \
+                    _buff[0] = '\0';                                                \
                 }                                                                    \
+                _lg.log(level, __FILE__, __LINE__, __func__, _buff);                 \
             }                                                                        \
-            _lg.log(level, __FILE__, __LINE__, __func__, _buff);                     \
         }                                                                            \
     } while (0)
+#endif
 
 #define LOG_DEBUG(fmt, ...) LOG_BASE(DEBUG, fmt, ##__VA_ARGS__)
 #define LOG_INFO(fmt, ...)  LOG_BASE(INFO,  fmt, ##__VA_ARGS__)
 #define LOG_WARN(fmt, ...)  LOG_BASE(WARN,  fmt, ##__VA_ARGS__)
 #define LOG_ERROR(fmt, ...) LOG_BASE(ERROR, fmt, ##__VA_ARGS__)
 
-#endif // LOGM_H
\ No newline at end of file
+#endif // LOGM_H
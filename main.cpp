@@ -3,6 +3,15 @@
 #include "LogM.h"
 #include "MySQLProc.h"
 #include "ConnectProc.h"
+#include "HashPool.h"
+#include "UserCache.h"
+#include "EmailFilter.h"
+#include "SessionStore.h"
+#include "SessionSnapshot.h"
+#include "TokenSigner.h"
+#include "RevocationSync.h"
+#include "AccessLog.h"
+#include <cstdlib>
 using namespace std;
 
 
@@ -22,10 +31,46 @@ int main()
 
     // 初始化数据库连接池
     ConnectionPool::init(DB_HOST, DB_USER, DB_PASSWORD, DB_NAME, 10, 2);
-
-    // 监听端口9000，多线程处理请求
-    while (true) {
-        ProcWebConnect(9000); // 若内部永久循环，此处可去掉 while(true)
+    // 扫描 sys_user 建立已注册邮箱过滤器，撞库时不存在的邮箱不再查库；
+    // 之后每秒增量扫描一次，补上其他进程注册的用户
+    if (EmailFilter::instance().build()) EmailFilter::instance().startRefresher();
+    // 用户信息缓存：最多 1 万个账号，5 分钟过期（命中率见 /api/metrics）
+    UserCache::init(10000, std::chrono::seconds(300));
+    // 密码哈希线程池：线程数取 CPU 核数的一半，最多排队 256 个登录/注册，
+    // 预计 2 秒内完成不了的新登录直接回 503 + Retry-After
+    HashPool::init(0, 256, 2000);
+    // 设置了 WEBSITE_TOKEN_SECRET 时启用无状态签名 token，多个后端进程共享同一密钥即可；
+    // 登出记录经 sys_token_revocation 表在进程间同步（每秒增量拉取），重启后从表中恢复
+    if (const char* secret = std::getenv("WEBSITE_TOKEN_SECRET")) {
+        TokenSigner::init(secret);
+        RevocationSync::instance().start();
+        LOG_INFO("Signed token mode enabled");
+    }
+    // 后台每秒清理过期会话
+    SessionStore::instance().startSweeper(std::chrono::seconds(1));
+    // 监听前从快照恢复会话，之后每秒追加变更，重启不会让用户掉线
+    const char* snapshotEnv = std::getenv("WEBSITE_SESSION_SNAPSHOT");
+    const std::string snapshotPath = snapshotEnv ? snapshotEnv : "sessions.snap";
+    static SessionSnapshot sessionSnapshot(SessionStore::instance());
+    sessionSnapshot.load(snapshotPath);
+    if (!sessionSnapshot.start(snapshotPath)) {
+        LOG_ERROR("Session snapshot disabled: cannot write %s", snapshotPath.c_str());
     }
-    return 0;
+
+    // 访问日志：每个请求一行 NDJSON，后台线程批量追加；WEBSITE_ACCESS_LOG 设为空串时关闭
+    const char* accessLogEnv = std::getenv("WEBSITE_ACCESS_LOG");
+    const std::string accessLogPath = accessLogEnv ? accessLogEnv : "./log/access.log";
+    if (!accessLogPath.empty()) AccessLog::instance().start(accessLogPath);
+
+    // 监听端口9000：epoll 事件循环 + 固定大小工作线程池
+    ServerOptions serverOptions;
+    serverOptions.workerThreads = 8;
+    serverOptions.maxConnections = 1024;
+    // /api/metrics 只对携带该令牌（Authorization: Bearer <token>）的请求开放，未设置时不提供
+    if (const char* metricsToken = std::getenv("WEBSITE_METRICS_TOKEN")) serverOptions.metricsToken = metricsToken;
+    // 只有监听失败或事件循环出错时才会返回，此时直接退出，交给进程管理器重启
+    int rc = ProcWebConnect(9000, serverOptions);
+    LOG_ERROR("Server stopped with code %d, exiting", rc);
+    AccessLog::instance().stop();
+    return rc;
 }
\ No newline at end of file